@@ -0,0 +1,140 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+// Measures the latency of code cache hits with 1, 8 and 64 threads looking up
+// (and claiming) cached graphs concurrently. In the first set of runs each
+// thread uses its own entry, as independent solvers would. In the second all
+// threads look up one shared entry holding an instance per thread, as threads
+// running the same solver would, so they contend for the same claims. Latency
+// is measured in thread CPU time so that it is not inflated when there are
+// more threads than processors.
+
+#include <desola/Desola.hpp>
+#include <TaskGraph>
+#include <cstdlib>
+#include <iostream>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/shared_ptr.hpp>
+#include <sys/time.h>
+#include <time.h>
+
+using namespace desola;
+using namespace desola::detail;
+
+namespace
+{
+
+typedef TGCache<double> GraphCache;
+typedef TGExpressionGraph<double> Graph;
+
+const std::size_t maxThreads = 64;
+
+double getTime()
+{
+  timeval time;
+  gettimeofday(&time, NULL);
+  return time.tv_sec + time.tv_usec/1000000.0;
+}
+
+double getThreadTime()
+{
+  timespec time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return time.tv_sec + time.tv_nsec/1000000000.0;
+}
+
+void lookup(GraphCache& cache, const Graph& graph, const std::size_t key, const std::size_t iterations, boost::barrier& barrier, double& elapsed)
+{
+  barrier.wait();
+  const double startTime = getThreadTime();
+
+  for(std::size_t iteration = 0; iteration < iterations; ++iteration)
+  {
+    GraphCache::Claim claim;
+    const boost::shared_ptr<Graph> cached(cache.acquire(key, graph, claim));
+
+    if (!cached)
+      std::abort();
+  }
+
+  elapsed = getThreadTime() - startTime;
+}
+
+// Runs with different thread counts use different shared entries
+std::size_t getSharedKey(const std::size_t threads)
+{
+  return maxThreads + threads;
+}
+
+void measure(GraphCache& cache, const Graph& probe, const char* const mode, const std::size_t threads, const bool sharedKey, const std::size_t iterations)
+{
+  std::vector<double> elapsed(threads);
+  boost::barrier barrier(threads);
+  boost::thread_group group;
+  const double startTime = getTime();
+
+  for(std::size_t thread = 0; thread < threads; ++thread)
+  {
+    const std::size_t key = sharedKey ? getSharedKey(threads) : thread;
+    group.create_thread(boost::bind(lookup, boost::ref(cache), boost::cref(probe), key, iterations, boost::ref(barrier), boost::ref(elapsed[thread])));
+  }
+
+  group.join_all();
+  const double wallTime = getTime() - startTime;
+
+  double total = 0.0;
+  for(std::size_t thread = 0; thread < threads; ++thread)
+    total += elapsed[thread];
+
+  std::cout << mode << ": Threads: " << threads << " Mean hit latency: " 
+            << (total / (threads * iterations)) * 1e9 << " ns"
+            << " Hits per second: " << (threads * iterations) / wallTime << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  const std::size_t iterations = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  Context context;
+  GraphCache& cache(context.getCache<GraphCache>());
+  const Graph probe(context);
+
+  const std::size_t threadCounts[] = {1, 8, 64};
+  const std::size_t runs = sizeof(threadCounts)/sizeof(threadCounts[0]);
+
+  for(std::size_t key = 0; key < maxThreads; ++key)
+    cache.insert(key, boost::shared_ptr<Graph>(new Graph(context)));
+
+  // A thread holds at most one claim, so one instance per thread guarantees a hit
+  for(std::size_t index = 0; index < runs; ++index)
+  {
+    for(std::size_t instance = 0; instance < threadCounts[index]; ++instance)
+      cache.insert(getSharedKey(threadCounts[index]), boost::shared_ptr<Graph>(new Graph(context)));
+  }
+
+  for(std::size_t index = 0; index < runs; ++index)
+    measure(cache, probe, "Independent keys", threadCounts[index], false, iterations);
+
+  for(std::size_t index = 0; index < runs; ++index)
+    measure(cache, probe, "Shared key", threadCounts[index], true, iterations);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+
+// Measures the heap allocations made while building and discarding the
+// expressions of a conjugate gradient iteration. Expression nodes come from
+// the node pool. Without the pool each of them would be a heap allocation.
+
+#include <desola/Desola.hpp>
+#include <cstdlib>
+#include <new>
+#include <iostream>
+#include <sys/time.h>
+
+using namespace desola;
+using namespace desola::detail;
+
+namespace
+{
+
+std::size_t heapAllocations = 0;
+
+double getTime()
+{
+  timeval time;
+  gettimeofday(&time, NULL);
+  return time.tv_sec + time.tv_usec/1000000.0;
+}
+
+void buildIteration(const Matrix<double>& a, const Vector<double>& x, const Vector<double>& r, const Vector<double>& p, const Scalar<double>& rho)
+{
+  const Vector<double> q(a * p);
+  const Scalar<double> alpha(rho / p.dot(q));
+  const Vector<double> xNext(x + p * alpha);
+  const Vector<double> rNext(r - q * alpha);
+  const Scalar<double> rhoNext(rNext.dot(rNext));
+  const Vector<double> pNext(rNext + p * (rhoNext / rho));
+}
+
+void* countedAllocate(const std::size_t size)
+{
+  ++heapAllocations;
+  void* const p = std::malloc(size == 0 ? 1 : size);
+
+  if (p == NULL)
+    throw std::bad_alloc();
+
+  return p;
+}
+
+}
+
+void* operator new(std::size_t size)
+{
+  return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+  return countedAllocate(size);
+}
+
+void operator delete(void* p) throw()
+{
+  std::free(p);
+}
+
+void operator delete[](void* p) throw()
+{
+  std::free(p);
+}
+
+int main(int argc, char* argv[])
+{
+  const std::size_t iterations = argc > 1 ? std::atoi(argv[1]) : 100000;
+  const std::size_t size = 64;
+
+  const Matrix<double> a(size, size);
+  const Vector<double> x(size, 0.0);
+  const Vector<double> r(size, 1.0);
+  const Vector<double> p(size, 1.0);
+  const Scalar<double> rho(1.0);
+
+  // Warm the pool so its chunks are not counted
+  buildIteration(a, x, r, p, rho);
+
+  const std::size_t startHeap = heapAllocations;
+  const std::size_t startPooled = NodePool::getAllocationCount();
+  const double startTime = getTime();
+
+  for(std::size_t iteration = 0; iteration < iterations; ++iteration)
+    buildIteration(a, x, r, p, rho);
+
+  const double elapsed = getTime() - startTime;
+  const double heap = static_cast<double>(heapAllocations - startHeap) / iterations;
+  const double pooled = static_cast<double>(NodePool::getAllocationCount() - startPooled) / iterations;
+
+  std::cout << "Pooled node allocations per iteration: " << pooled << std::endl;
+  std::cout << "Heap allocations per iteration: " << heap << " (" << heap + pooled << " without pooling)" << std::endl;
+  std::cout << "Time per iteration: " << (elapsed / iterations) * 1e6 << " us" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,655 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+
+#ifndef DESOLA_ALGEBRAIC_SIMPLIFIER_HPP
+#define DESOLA_ALGEBRAIC_SIMPLIFIER_HPP
+
+#include <cstddef>
+#include <cassert>
+#include <vector>
+#include <boost/array.hpp>
+#include <desola/Desola_fwd.hpp>
+
+namespace desola
+{
+
+namespace detail
+{
+
+// Returns the node if it has exactly the type T_node, otherwise NULL
+template<typename T_node, typename T_element>
+class ExpressionNodeMatcher : public ExpressionNodeVisitor<T_element>
+{
+private:
+  T_node* matched;
+
+  void capture(T_node& e)
+  {
+    matched = &e;
+  }
+
+  template<typename T_other>
+  void capture(T_other& e)
+  {
+  }
+
+  ExpressionNodeMatcher() : matched(NULL)
+  {
+  }
+
+public:
+  static T_node* match(ExpressionNode<T_element>& node)
+  {
+    ExpressionNodeMatcher matcher;
+    node.accept(matcher);
+    return matcher.matched;
+  }
+
+  virtual void visit(Pairwise<scalar, T_element>& e) { capture(e); }
+  virtual void visit(Pairwise<vector, T_element>& e) { capture(e); }
+  virtual void visit(Pairwise<matrix, T_element>& e) { capture(e); }
+  virtual void visit(ScalarPiecewise<scalar, T_element>& e) { capture(e); }
+  virtual void visit(ScalarPiecewise<vector, T_element>& e) { capture(e); }
+  virtual void visit(ScalarPiecewise<matrix, T_element>& e) { capture(e); }
+  virtual void visit(MatrixMult<T_element>& e) { capture(e); }
+  virtual void visit(MatrixVectorMult<T_element>& e) { capture(e); }
+  virtual void visit(TransposeMatrixVectorMult<T_element>& e) { capture(e); }
+  virtual void visit(VectorDot<T_element>& e) { capture(e); }
+  virtual void visit(VectorCross<T_element>& e) { capture(e); }
+  virtual void visit(VectorTwoNorm<T_element>& e) { capture(e); }
+  virtual void visit(VectorAxpby<T_element>& e) { capture(e); }
+  virtual void visit(MatrixTranspose<T_element>& e) { capture(e); }
+  virtual void visit(ElementGet<vector, T_element>& e) { capture(e); }
+  virtual void visit(ElementGet<matrix, T_element>& e) { capture(e); }
+  virtual void visit(ElementSet<vector, T_element>& e) { capture(e); }
+  virtual void visit(ElementSet<matrix, T_element>& e) { capture(e); }
+  virtual void visit(Slice<vector, T_element>& e) { capture(e); }
+  virtual void visit(Slice<matrix, T_element>& e) { capture(e); }
+  virtual void visit(Literal<scalar, T_element>& e) { capture(e); }
+  virtual void visit(Literal<vector, T_element>& e) { capture(e); }
+  virtual void visit(Literal<matrix, T_element>& e) { capture(e); }
+  virtual void visit(Negate<scalar, T_element>& e) { capture(e); }
+  virtual void visit(Negate<vector, T_element>& e) { capture(e); }
+  virtual void visit(Negate<matrix, T_element>& e) { capture(e); }
+  virtual void visit(Absolute<T_element>& e) { capture(e); }
+  virtual void visit(SquareRoot<T_element>& e) { capture(e); }
+};
+
+// Rewrites a topologically sorted node list using local algebraic rules:
+//
+//   -(-x)                 -> x
+//   trans(trans(A))       -> A
+//   (x * a) * b           -> x * (a * b)    for vectors, and likewise for division, if enabled
+//   x * a + y * b         -> axpby(x, a, y, b)
+//   x + 0, x - 0, x * 1   -> x
+//   x * 0, x - x, A * 0   -> 0              with a constant of the result's shape
+//   I * x, A * I          -> x, A
+//   trans(A) * x          -> transposed product of A and x, and vice versa
+//   slice(slice(x))       -> slice(x)
+//   slice(x)              -> x              when it covers all of x
+//   c1 op c2              -> c              for constant operands
+//
+// Scalar piecewise chains are only folded when the inner node has no other
+// users. Folding reassociates the scalar factors and so may change the
+// result in the last place, so it is only done when scalar reassociation is
+// enabled. An unscaled axpby operand is multiplied by a literal one, which
+// leaves its value unchanged.
+//
+// Constants are literals whose elements are all known without evaluation:
+// scalars constructed from a value rather than computed, and filled vectors,
+// zero and identity matrices which have not been stored yet. Rules that produce zero ignore any infinities or
+// NaNs in the other operand.
+//
+// Once the first rule fires every node in the list is held by a pin, so that
+// nodes made unused by a rewrite remain valid until the pass completes. They
+// are then removed from the list and freed.
+template<typename T_element>
+class AlgebraicSimplifier : public ExpressionNodeVisitor<T_element>
+{
+private:
+  std::vector<ExpressionNode<T_element>*>* nodes;
+  ExpressionNode<T_element>* preserved;
+  const NodePin<T_element> pin;
+  Literal<scalar, T_element>* unit;
+  std::size_t position;
+  bool pinned;
+  bool rewritten;
+  int rewriteCount;
+  const bool reassociate;
+
+  void pinAll()
+  {
+    if (!pinned)
+    {
+      for(typename std::vector<ExpressionNode<T_element>*>::iterator nodeIter = nodes->begin(); nodeIter != nodes->end(); ++nodeIter)
+      {
+        if (*nodeIter != preserved)
+          (*nodeIter)->registerRequiredBy(pin);
+      }
+
+      pinned = true;
+    }
+  }
+
+  std::size_t getExternalUserCount(const ExpressionNode<T_element>& node) const
+  {
+    const std::size_t count = node.getExternalRequiredByCount();
+    return pinned && &node != preserved ? count - 1 : count;
+  }
+
+  bool isUnused(const ExpressionNode<T_element>& node) const
+  {
+    return &node != preserved && node.getInternalRequiredByCount() == 0 && getExternalUserCount(node) == 0;
+  }
+
+  // Only nodes used solely by the node being rewritten may be absorbed into it
+  bool isSingleUse(const ExpressionNode<T_element>& node) const
+  {
+    return &node != preserved && preserved->sharesGraphWith(&node) && node.getInternalRequiredByCount() == 1 && getExternalUserCount(node) == 0;
+  }
+
+  // Adds a newly created node in front of the node being rewritten
+  void insert(ExpressionNode<T_element>& node)
+  {
+    pinAll();
+    node.adoptContext(*preserved);
+    node.registerRequiredBy(pin);
+    nodes->insert(nodes->begin() + position, &node);
+    ++position;
+  }
+
+  template<typename exprType>
+  void replace(ExprNode<exprType, T_element>& previous, ExprNode<exprType, T_element>& next)
+  {
+    assert(&previous != preserved);
+    assert((*nodes)[position] == &previous);
+
+    pinAll();
+    previous.replace(next);
+    nodes->erase(nodes->begin() + position);
+    previous.unregisterRequiredBy(pin);
+
+    rewritten = true;
+    ++rewriteCount;
+  }
+
+  ExprNode<scalar, T_element>& getUnit()
+  {
+    if (unit == NULL)
+    {
+      unit = new Literal<scalar, T_element>(new ConventionalScalar<T_element>(1));
+      insert(*unit);
+    }
+
+    return *unit;
+  }
+
+  template<typename exprType>
+  static bool getUniformValue(ExprNode<exprType, T_element>& e, T_element& value)
+  {
+    Literal<exprType, T_element>* const literal = ExpressionNodeMatcher<Literal<exprType, T_element>, T_element>::match(e);
+    return literal != NULL && literal->getValue().isUniform(value);
+  }
+
+  template<typename exprType>
+  static bool isUniform(ExprNode<exprType, T_element>& e, const T_element value)
+  {
+    T_element uniform;
+    return getUniformValue(e, uniform) && uniform == value;
+  }
+
+  static bool isIdentity(ExprNode<matrix, T_element>& e)
+  {
+    Literal<matrix, T_element>* const literal = ExpressionNodeMatcher<Literal<matrix, T_element>, T_element>::match(e);
+    return literal != NULL && literal->getValue().isIdentity();
+  }
+
+  static InternalScalar<T_element>* createUniform(const boost::array<std::size_t, 0>& dims, const T_element value)
+  {
+    return new ConventionalScalar<T_element>(value);
+  }
+
+  static InternalVector<T_element>* createUniform(const boost::array<std::size_t, 1>& dims, const T_element value)
+  {
+    return new ConventionalVector<T_element>(dims[0], value);
+  }
+
+  static InternalMatrix<T_element>* createUniform(const boost::array<std::size_t, 2>& dims, const T_element value)
+  {
+    return new ConventionalMatrix<T_element>(dims[0], dims[1], value, value);
+  }
+
+  template<typename exprType>
+  void replaceWithUniform(ExprNode<exprType, T_element>& e, const T_element value)
+  {
+    Literal<exprType, T_element>* const literal = new Literal<exprType, T_element>(createUniform(e.getDims(), value));
+    insert(*literal);
+    replace(e, *literal);
+  }
+
+  static T_element apply(const PairwiseOp op, const T_element left, const T_element right)
+  {
+    switch(op)
+    {
+      case pair_add: return left + right;
+      case pair_sub: return left - right;
+      case pair_mul: return left * right;
+      case pair_div: return left / right;
+    }
+
+    assert(false);
+    return T_element();
+  }
+
+  template<typename exprType>
+  void simplifyConstantPairwise(Pairwise<exprType, T_element>& e)
+  {
+    ExprNode<exprType, T_element>& left(e.getLeft());
+    ExprNode<exprType, T_element>& right(e.getRight());
+    T_element leftValue, rightValue;
+    const bool leftKnown = getUniformValue(left, leftValue);
+    const bool rightKnown = getUniformValue(right, rightValue);
+    const T_element zero(0), one(1);
+
+    if (leftKnown && rightKnown)
+    {
+      replaceWithUniform(e, apply(e.getOperation(), leftValue, rightValue));
+      return;
+    }
+
+    switch(e.getOperation())
+    {
+      case pair_add:
+        if (leftKnown && leftValue == zero)
+          replace(e, right);
+        else if (rightKnown && rightValue == zero)
+          replace(e, left);
+        break;
+
+      case pair_sub:
+        if (rightKnown && rightValue == zero)
+        {
+          replace(e, left);
+        }
+        else if (&left == &right)
+        {
+          replaceWithUniform(e, zero);
+        }
+        else if (leftKnown && leftValue == zero)
+        {
+          Negate<exprType, T_element>* const negated = new Negate<exprType, T_element>(right);
+          insert(*negated);
+          replace(e, *negated);
+        }
+        break;
+
+      case pair_mul:
+        if ((leftKnown && leftValue == zero) || (rightKnown && rightValue == zero))
+          replaceWithUniform(e, zero);
+        else if (leftKnown && leftValue == one)
+          replace(e, right);
+        else if (rightKnown && rightValue == one)
+          replace(e, left);
+        break;
+
+      case pair_div:
+        if (rightKnown && rightValue == one)
+          replace(e, left);
+        break;
+    }
+  }
+
+  template<typename exprType>
+  void simplifyConstantScalarPiecewise(ScalarPiecewise<exprType, T_element>& e)
+  {
+    T_element operandValue, scalarValue;
+    const bool operandKnown = getUniformValue(e.getLeft(), operandValue);
+    const bool scalarKnown = getUniformValue(e.getRight(), scalarValue);
+    const T_element zero(0), one(1);
+
+    switch(e.getOperation())
+    {
+      case piecewise_multiply:
+        if ((operandKnown && operandValue == zero) || (scalarKnown && scalarValue == zero))
+          replaceWithUniform(e, zero);
+        else if (scalarKnown && scalarValue == one)
+          replace(e, e.getLeft());
+        else if (operandKnown && scalarKnown)
+          replaceWithUniform(e, operandValue * scalarValue);
+        break;
+
+      case piecewise_divide:
+        if (scalarKnown && scalarValue == one)
+          replace(e, e.getLeft());
+        else if (operandKnown && scalarKnown)
+          replaceWithUniform(e, operandValue / scalarValue);
+        break;
+
+      case piecewise_assign:
+        if (scalarKnown)
+          replaceWithUniform(e, scalarValue);
+        break;
+    }
+  }
+
+  template<typename exprType>
+  void simplifyNegate(Negate<exprType, T_element>& e)
+  {
+    Negate<exprType, T_element>* const inner = ExpressionNodeMatcher<Negate<exprType, T_element>, T_element>::match(e.getOperand());
+    T_element value;
+
+    if (inner != NULL)
+      replace(e, inner->getOperand());
+    else if (getUniformValue(e.getOperand(), value))
+      replaceWithUniform(e, -value);
+  }
+
+  template<typename exprType>
+  void simplifyScalarPiecewise(ScalarPiecewise<exprType, T_element>& e)
+  {
+    simplifyConstantScalarPiecewise(e);
+
+    if (rewritten || !reassociate)
+      return;
+
+    ScalarPiecewise<exprType, T_element>* const inner = ExpressionNodeMatcher<ScalarPiecewise<exprType, T_element>, T_element>::match(e.getLeft());
+
+    if (inner == NULL || !isSingleUse(*inner))
+      return;
+
+    const ScalarPiecewiseOp outerOp = e.getOperation();
+    const ScalarPiecewiseOp innerOp = inner->getOperation();
+
+    if (outerOp == piecewise_assign || innerOp == piecewise_assign)
+      return;
+
+    ExprNode<scalar, T_element>& a(inner->getRight());
+    ExprNode<scalar, T_element>& b(e.getRight());
+    Pairwise<scalar, T_element>* factor;
+
+    if (innerOp == outerOp)
+      factor = new Pairwise<scalar, T_element>(pair_mul, a, b);
+    else if (outerOp == piecewise_multiply)
+      factor = new Pairwise<scalar, T_element>(pair_div, b, a);
+    else
+      factor = new Pairwise<scalar, T_element>(pair_div, a, b);
+
+    insert(*factor);
+    ScalarPiecewise<exprType, T_element>* const folded = new ScalarPiecewise<exprType, T_element>(innerOp == outerOp ? outerOp : piecewise_multiply, inner->getLeft(), *factor);
+    insert(*folded);
+    replace(e, *folded);
+  }
+
+  ScalarPiecewise<vector, T_element>* getScaled(ExprNode<vector, T_element>& e) const
+  {
+    ScalarPiecewise<vector, T_element>* const scaled = ExpressionNodeMatcher<ScalarPiecewise<vector, T_element>, T_element>::match(e);
+
+    if (scaled != NULL && scaled->getOperation() == piecewise_multiply && isSingleUse(*scaled))
+      return scaled;
+    else
+      return NULL;
+  }
+
+public:
+  explicit AlgebraicSimplifier(const bool r) : nodes(NULL), preserved(NULL), unit(NULL), position(0), pinned(false), rewritten(false), 
+    rewriteCount(0), reassociate(r)
+  {
+  }
+
+  // The preserved node is never replaced, since the caller may still be using it
+  void simplify(std::vector<ExpressionNode<T_element>*>& n, ExpressionNode<T_element>& p)
+  {
+    nodes = &n;
+    preserved = &p;
+
+    std::size_t index = 0;
+    while(index < nodes->size())
+    {
+      ExpressionNode<T_element>* const node = (*nodes)[index];
+      position = index;
+      rewritten = false;
+
+      // Literals from other threads and nodes bound to other contexts belong to graphs we may not rewrite
+      if (node != preserved && preserved->sharesGraphWith(node) && !isUnused(*node))
+        node->accept(*this);
+
+      // Nodes created by a rewrite are examined in turn, so rules can cascade
+      if (!rewritten)
+        ++index;
+    }
+
+    if (pinned)
+    {
+      // Users follow their dependencies, so a reverse walk frees whole unused subgraphs
+      std::vector<ExpressionNode<T_element>*> kept;
+      for(typename std::vector<ExpressionNode<T_element>*>::reverse_iterator nodeIter = nodes->rbegin(); nodeIter != nodes->rend(); ++nodeIter)
+      {
+        ExpressionNode<T_element>* const node = *nodeIter;
+
+        if (node != preserved)
+        {
+          if (!isUnused(*node))
+            kept.push_back(node);
+
+          node->unregisterRequiredBy(pin);
+        }
+        else
+        {
+          kept.push_back(node);
+        }
+      }
+
+      nodes->assign(kept.rbegin(), kept.rend());
+      pinned = false;
+    }
+  }
+
+  int getRewriteCount() const
+  {
+    return rewriteCount;
+  }
+
+  virtual void visit(Pairwise<vector, T_element>& e)
+  {
+    simplifyConstantPairwise(e);
+
+    if (rewritten || (e.getOperation() != pair_add && e.getOperation() != pair_sub))
+      return;
+
+    ScalarPiecewise<vector, T_element>* const left = getScaled(e.getLeft());
+    ScalarPiecewise<vector, T_element>* const right = getScaled(e.getRight());
+
+    if (left == NULL && right == NULL)
+      return;
+
+    ExprNode<vector, T_element>& x(left != NULL ? left->getLeft() : e.getLeft());
+    ExprNode<scalar, T_element>& alpha(left != NULL ? left->getRight() : getUnit());
+    ExprNode<vector, T_element>& y(right != NULL ? right->getLeft() : e.getRight());
+    ExprNode<scalar, T_element>& beta(right != NULL ? right->getRight() : getUnit());
+
+    VectorAxpby<T_element>* const axpby = new VectorAxpby<T_element>(e.getOperation(), x, alpha, y, beta);
+    insert(*axpby);
+    replace(e, *axpby);
+  }
+
+  virtual void visit(ScalarPiecewise<vector, T_element>& e)
+  {
+    simplifyScalarPiecewise(e);
+  }
+
+  virtual void visit(MatrixTranspose<T_element>& e)
+  {
+    MatrixTranspose<T_element>* const inner = ExpressionNodeMatcher<MatrixTranspose<T_element>, T_element>::match(e.getOperand());
+    T_element value;
+
+    if (inner != NULL)
+      replace(e, inner->getOperand());
+    else if (isIdentity(e.getOperand()))
+      replace(e, e.getOperand());
+    else if (getUniformValue(e.getOperand(), value))
+      replaceWithUniform(e, value);
+  }
+
+  // A slice with the dimensions of its operand must cover all of it
+  template<typename exprType>
+  void simplifySlice(Slice<exprType, T_element>& e)
+  {
+    Slice<exprType, T_element>* const inner = ExpressionNodeMatcher<Slice<exprType, T_element>, T_element>::match(e.getOperand());
+    T_element value;
+
+    if (e.getDims() == e.getOperand().getDims())
+    {
+      replace(e, e.getOperand());
+    }
+    else if (getUniformValue(e.getOperand(), value))
+    {
+      replaceWithUniform(e, value);
+    }
+    else if (inner != NULL)
+    {
+      Slice<exprType, T_element>* const sliced = new Slice<exprType, T_element>(inner->getOperand(), e.getDims(), 
+        inner->getSourceIndex(e.getOffset()), getSlicedStride(e.getStride(), inner->getStride()));
+      insert(*sliced);
+      replace(e, *sliced);
+    }
+  }
+
+  template<typename T_product, typename T_flipped>
+  void simplifyMatrixVectorMult(T_product& e)
+  {
+    MatrixTranspose<T_element>* const transposed = ExpressionNodeMatcher<MatrixTranspose<T_element>, T_element>::match(e.getLeft());
+
+    if (isUniform(e.getLeft(), T_element(0)) || isUniform(e.getRight(), T_element(0)))
+    {
+      replaceWithUniform(e, T_element(0));
+    }
+    else if (isIdentity(e.getLeft()))
+    {
+      replace(e, e.getRight());
+    }
+    else if (transposed != NULL)
+    {
+      T_flipped* const flipped = new T_flipped(transposed->getOperand(), e.getRight());
+      insert(*flipped);
+      replace(e, *flipped);
+    }
+  }
+
+  virtual void visit(MatrixVectorMult<T_element>& e)
+  {
+    simplifyMatrixVectorMult<MatrixVectorMult<T_element>, TransposeMatrixVectorMult<T_element> >(e);
+  }
+
+  virtual void visit(TransposeMatrixVectorMult<T_element>& e)
+  {
+    simplifyMatrixVectorMult<TransposeMatrixVectorMult<T_element>, MatrixVectorMult<T_element> >(e);
+  }
+
+  virtual void visit(MatrixMult<T_element>& e)
+  {
+    if (isUniform(e.getLeft(), T_element(0)) || isUniform(e.getRight(), T_element(0)))
+      replaceWithUniform(e, T_element(0));
+    else if (isIdentity(e.getLeft()))
+      replace(e, e.getRight());
+    else if (isIdentity(e.getRight()))
+      replace(e, e.getLeft());
+  }
+
+  virtual void visit(VectorDot<T_element>& e)
+  {
+    if (isUniform(e.getLeft(), T_element(0)) || isUniform(e.getRight(), T_element(0)))
+      replaceWithUniform(e, T_element(0));
+  }
+
+  virtual void visit(VectorTwoNorm<T_element>& e)
+  {
+    if (isUniform(e.getOperand(), T_element(0)))
+      replaceWithUniform(e, T_element(0));
+  }
+
+  virtual void visit(Negate<scalar, T_element>& e)
+  {
+    simplifyNegate(e);
+  }
+
+  virtual void visit(Negate<vector, T_element>& e)
+  {
+    simplifyNegate(e);
+  }
+
+  virtual void visit(Negate<matrix, T_element>& e)
+  {
+    simplifyNegate(e);
+  }
+
+  virtual void visit(Pairwise<scalar, T_element>& e)
+  {
+    simplifyConstantPairwise(e);
+  }
+
+  // Sparse matrices are never replaced by dense constants
+  virtual void visit(Pairwise<matrix, T_element>& e)
+  {
+    T_element value;
+
+    if (getUniformValue(e.getLeft(), value) || getUniformValue(e.getRight(), value))
+      simplifyConstantPairwise(e);
+  }
+
+  virtual void visit(ScalarPiecewise<scalar, T_element>& e)
+  {
+    simplifyConstantScalarPiecewise(e);
+  }
+
+  virtual void visit(ScalarPiecewise<matrix, T_element>& e)
+  {
+    T_element value;
+
+    if (getUniformValue(e.getLeft(), value))
+      simplifyConstantScalarPiecewise(e);
+  }
+
+  virtual void visit(VectorCross<T_element>& e) {}
+  virtual void visit(VectorAxpby<T_element>& e) {}
+  virtual void visit(ElementGet<vector, T_element>& e) {}
+  virtual void visit(ElementGet<matrix, T_element>& e) {}
+  virtual void visit(ElementSet<vector, T_element>& e) {}
+  virtual void visit(ElementSet<matrix, T_element>& e) {}
+
+  virtual void visit(Slice<vector, T_element>& e)
+  {
+    simplifySlice(e);
+  }
+
+  virtual void visit(Slice<matrix, T_element>& e)
+  {
+    simplifySlice(e);
+  }
+
+  virtual void visit(Literal<scalar, T_element>& e) {}
+  virtual void visit(Literal<vector, T_element>& e) {}
+  virtual void visit(Literal<matrix, T_element>& e) {}
+  virtual void visit(Absolute<T_element>& e) {}
+  virtual void visit(SquareRoot<T_element>& e) {}
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,232 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef DESOLA_ASYNC_EVALUATION_HPP
+#define DESOLA_ASYNC_EVALUATION_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <boost/shared_ptr.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/exception_ptr.hpp>
+#include <desola/Desola_fwd.hpp>
+#include <desola/ExecutionQueue.hpp>
+
+namespace desola
+{
+
+namespace detail
+{
+
+// An evaluation whose evaluators run on the execution thread of its context. The expression
+// graph is collected and prepared on the thread that built it.
+//
+// Deferred evaluations publish their results when completed, on the thread that started them.
+// At most one is pending per thread: starting another evaluation completes the pending one
+// first, so the nodes it replaces are never evaluated twice.
+//
+// Pipelined evaluations publish their results immediately. The literals holding them are
+// marked with the evaluation's ticket, so reading them waits until they have been computed and
+// evaluations using them as inputs wait for it on the execution thread. The thread that started
+// them releases their literals once they have finished.
+template<typename T_element>
+class AsyncEvaluation
+{
+private:
+  AsyncEvaluation(const AsyncEvaluation&);
+  AsyncEvaluation& operator=(const AsyncEvaluation&);
+
+  typedef std::deque< boost::shared_ptr<AsyncEvaluation> > PipelinedQueue;
+
+  // Host threads may only run this many pipelined evaluations ahead of the execution thread
+  static const std::size_t maxPipelined = 2;
+
+  static boost::thread_specific_ptr< boost::shared_ptr<AsyncEvaluation> > pending;
+  static boost::thread_specific_ptr<PipelinedQueue> pipelined;
+
+  const boost::thread::id creator;
+  const bool publishImmediately;
+  std::auto_ptr< ExpressionGraph<T_element> > expressionGraph;
+  boost::shared_ptr< EvaluationStrategy<T_element> > strategy;
+  std::vector<ExpressionNode<T_element>*> nodes;
+  const NodePin<T_element> pin;
+  const boost::shared_ptr<ExecutionTicket> ticket;
+  bool completed;
+
+  AsyncEvaluation(Context& context, const std::vector<ExpressionNode<T_element>*>& n, std::auto_ptr< ExpressionGraph<T_element> > graph, 
+                  const boost::shared_ptr< EvaluationStrategy<T_element> >& s, const bool p) : creator(boost::this_thread::get_id()), 
+                  publishImmediately(p), expressionGraph(graph), strategy(s), nodes(n), ticket(new ExecutionTicket()), completed(false)
+  {
+    strategy->prepare();
+
+    // The evaluators only access literals, so once the other nodes have been replaced only the
+    // literals need to outlive the variables using them. Keeping the replaced nodes would leave
+    // them visible to the next expression graph built on this thread.
+    if (publishImmediately)
+    {
+      nodes = strategy->getLiterals();
+      strategy->setProducer(ticket);
+    }
+
+    for(typename std::vector<ExpressionNode<T_element>*>::const_iterator nodeIter = nodes.begin(); nodeIter != nodes.end(); ++nodeIter)
+      (*nodeIter)->registerRequiredBy(pin);
+
+    context.getExecutionQueue().submit(boost::bind(&AsyncEvaluation::run, this), ticket);
+
+    if (publishImmediately)
+      strategy->publish();
+  }
+
+  void run()
+  {
+    strategy->waitForInputs();
+    strategy->run();
+  }
+
+  void unpin()
+  {
+    // Dependents are unpinned first so each node is freed as soon as it becomes unused
+    for(typename std::vector<ExpressionNode<T_element>*>::const_reverse_iterator nodeIter = nodes.rbegin(); nodeIter != nodes.rend(); ++nodeIter)
+      (*nodeIter)->unregisterRequiredBy(pin);
+  }
+
+  // Releases finished pipelined evaluations, waiting if more than limit are outstanding
+  static void releasePipelined(const std::size_t limit)
+  {
+    PipelinedQueue* const queue = pipelined.get();
+
+    while(queue != NULL && !queue->empty() && (queue->front()->isReady() || queue->size() > limit))
+    {
+      const boost::shared_ptr<AsyncEvaluation> evaluation(queue->front());
+      queue->pop_front();
+      evaluation->complete();
+    }
+  }
+
+public:
+  static boost::shared_ptr<AsyncEvaluation> start(Context& context, const std::vector<ExpressionNode<T_element>*>& nodes, std::auto_ptr< ExpressionGraph<T_element> > graph,
+                                                  const boost::shared_ptr< EvaluationStrategy<T_element> >& strategy, const bool publishImmediately)
+  {
+    assert(pending.get() == NULL);
+
+    // Throttle before queueing more work
+    if (publishImmediately)
+      releasePipelined(maxPipelined - 1);
+
+    const boost::shared_ptr<AsyncEvaluation> evaluation(new AsyncEvaluation(context, nodes, graph, strategy, publishImmediately));
+
+    if (publishImmediately)
+    {
+      if (pipelined.get() == NULL)
+        pipelined.reset(new PipelinedQueue());
+
+      pipelined->push_back(evaluation);
+    }
+    else
+    {
+      pending.reset(new boost::shared_ptr<AsyncEvaluation>(evaluation));
+    }
+
+    return evaluation;
+  }
+
+  // Completes the deferred evaluation pending on this thread, if any, and releases finished
+  // pipelined evaluations. Returns false if the node was replaced by a deferred evaluation and
+  // is no longer required, in which case it has been deleted.
+  static bool completePending(ExpressionNode<T_element>& node)
+  {
+    releasePipelined(maxPipelined);
+
+    if (pending.get() == NULL)
+      return true;
+
+    const boost::shared_ptr<AsyncEvaluation> evaluation(*pending);
+    const NodePin<T_element> nodePin;
+    node.registerRequiredBy(nodePin);
+
+    try
+    {
+      evaluation->complete();
+    }
+    catch(...)
+    {
+      node.unregisterRequiredBy(nodePin);
+      throw;
+    }
+
+    const bool required = node.getInternalRequiredByCount() > 0 || node.getExternalRequiredByCount() > 1;
+    node.unregisterRequiredBy(nodePin);
+    return required;
+  }
+
+  bool isReady() const
+  {
+    return completed || ticket->isComplete();
+  }
+
+  // Errors raised by pipelined evaluations are rethrown when their results are read
+  void complete()
+  {
+    if (!completed)
+    {
+      //FIXME: Throw an exception when completed from a thread other than the one that started it
+      assert(creator == boost::this_thread::get_id());
+      completed = true;
+
+      if (pending.get() != NULL && pending->get() == this)
+        pending.reset();
+
+      ticket->wait();
+      const boost::exception_ptr error(ticket->getError());
+
+      if (!publishImmediately && !error)
+        strategy->publish();
+
+      unpin();
+
+      if (!publishImmediately && error)
+        boost::rethrow_exception(error);
+    }
+  }
+
+  ~AsyncEvaluation()
+  {
+    // Only reached without completion if the starting thread exits with evaluations outstanding
+    if (!completed)
+    {
+      ticket->wait();
+      unpin();
+    }
+  }
+};
+
+template<typename T_element>
+boost::thread_specific_ptr< boost::shared_ptr< AsyncEvaluation<T_element> > > AsyncEvaluation<T_element>::pending;
+
+template<typename T_element>
+boost::thread_specific_ptr< typename AsyncEvaluation<T_element>::PipelinedQueue > AsyncEvaluation<T_element>::pipelined;
+
+}
+
+}
+
+#endif
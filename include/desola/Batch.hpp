@@ -0,0 +1,312 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef DESOLA_BATCH_HPP
+#define DESOLA_BATCH_HPP
+
+#include <cstddef>
+#include <vector>
+#include <map>
+#include <utility>
+#include <cassert>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <desola/Desola_fwd.hpp>
+#include <desola/Context.hpp>
+
+//NOTE: A batch holds many small independent systems with the same sparsity
+//      pattern. The systems are stored as one block diagonal CRS matrix, and
+//      batch vectors store each system's elements contiguously. Per-system
+//      reductions and scalings are expressed as products with sparse
+//      segment matrices. All systems of a batch are advanced by the same
+//      expression graph, so a solver iteration compiles to a single kernel.
+
+namespace desola
+{
+
+namespace detail
+{
+
+// Presents a list of matrix entries through the interface of the matrix file streams
+template<typename T_element>
+class EntryStream
+{
+private:
+  const int rows;
+  const int cols;
+  std::vector< entry2<T_element> > entries;
+  std::size_t position;
+
+public:
+  EntryStream(const std::size_t rowCount, const std::size_t colCount) : rows(rowCount), cols(colCount), position(0)
+  {
+  }
+
+  void add(const int row, const int col, const T_element value)
+  {
+    entries.push_back(entry2<T_element>(row, col, value));
+  }
+
+  inline int nrows() const { return rows; }
+  inline int ncols() const { return cols; }
+  inline int nnz() const { return entries.size(); }
+  inline bool eof() const { return position == entries.size(); }
+
+  template<typename T_entry>
+  EntryStream& operator>>(entry2<T_entry>& entry)
+  {
+    assert(!eof());
+    const entry2<T_element>& next(entries[position++]);
+    entry = entry2<T_entry>(next.row, next.col, next.value);
+    return *this;
+  }
+};
+
+// Segment matrices shared by all batch matrices and vectors of the same shape and context
+template<typename T_element>
+class BatchLayout
+{
+private:
+  typedef std::pair< std::pair<std::size_t, std::size_t>, const Context*> LayoutKey;
+  typedef std::map< LayoutKey, boost::weak_ptr<const BatchLayout> > LayoutMap;
+
+  static boost::mutex layoutsMutex;
+  static LayoutMap layouts;
+
+  const std::size_t batchSize;
+  const std::size_t systemSize;
+
+  // batchSize x (batchSize*systemSize): sums the elements of each system
+  Matrix<T_element> segmentSum;
+
+  // (batchSize*systemSize) x batchSize: broadcasts a value to each element of a system
+  Matrix<T_element> segmentExpand;
+
+  BatchLayout(const std::size_t batch, const std::size_t system, Context* const context) : batchSize(batch), systemSize(system)
+  {
+    const std::size_t rows = batchSize * systemSize;
+    EntryStream<T_element> sumStream(batchSize, rows);
+    EntryStream<T_element> expandStream(rows, batchSize);
+
+    for(std::size_t row = 0; row < rows; ++row)
+    {
+      sumStream.add(row / systemSize, row, T_element(1));
+      expandStream.add(row, row / systemSize, T_element(1));
+    }
+
+    segmentSum = createMatrix(sumStream, context);
+    segmentExpand = createMatrix(expandStream, context);
+  }
+
+public:
+  // Layouts are only kept while a batch of their shape is in use
+  static boost::shared_ptr<const BatchLayout> getLayout(const std::size_t batch, const std::size_t system, Context* const context)
+  {
+    boost::mutex::scoped_lock lock(layoutsMutex);
+    boost::weak_ptr<const BatchLayout>& cached(layouts[LayoutKey(std::make_pair(batch, system), context)]);
+    boost::shared_ptr<const BatchLayout> layout(cached.lock());
+
+    if (!layout)
+    {
+      layout.reset(new BatchLayout(batch, system, context));
+      cached = layout;
+    }
+
+    return layout;
+  }
+
+  // Loads a sparse matrix, binding it to the context if one is specified
+  static Matrix<T_element> createMatrix(EntryStream<T_element>& stream, Context* const context)
+  {
+    const Matrix<T_element> result(Matrix<T_element>::createSparse(stream));
+
+    if (context != NULL)
+      result.bindContext(*context);
+
+    return result;
+  }
+
+  inline std::size_t getBatchSize() const { return batchSize; }
+  inline std::size_t getSystemSize() const { return systemSize; }
+  inline const Matrix<T_element>& getSegmentSum() const { return segmentSum; }
+  inline const Matrix<T_element>& getSegmentExpand() const { return segmentExpand; }
+};
+
+template<typename T_element>
+boost::mutex BatchLayout<T_element>::layoutsMutex;
+
+template<typename T_element>
+typename BatchLayout<T_element>::LayoutMap BatchLayout<T_element>::layouts;
+
+}
+
+template<typename T_element>
+class BatchVector
+{
+private:
+  boost::shared_ptr< const detail::BatchLayout<T_element> > layout;
+  Vector<T_element> values;
+
+  BatchVector(const boost::shared_ptr< const detail::BatchLayout<T_element> >& l, const Vector<T_element>& v) : layout(l), values(v)
+  {
+  }
+
+  static Vector<T_element> createVector(const std::size_t size, const T_element* const data)
+  {
+    assert(data != NULL);
+    return Vector<T_element>(*new detail::Literal<detail::vector, T_element>(new detail::ConventionalVector<T_element>(data, data + size)));
+  }
+
+public:
+  friend class BatchMatrix<T_element>;
+
+  // Element j of system i is stored at i*systemSize + j
+  BatchVector(const std::size_t batchSize, const std::size_t systemSize, const T_element initialValue = T_element()) : 
+    layout(detail::BatchLayout<T_element>::getLayout(batchSize, systemSize, NULL)), values(batchSize * systemSize, initialValue)
+  {
+  }
+
+  BatchVector(const std::size_t batchSize, const std::size_t systemSize, const T_element initialValue, Context& context) : 
+    layout(detail::BatchLayout<T_element>::getLayout(batchSize, systemSize, &context)), values(batchSize * systemSize, initialValue, context)
+  {
+  }
+
+  BatchVector(const std::size_t batchSize, const std::size_t systemSize, const T_element* const data) : 
+    layout(detail::BatchLayout<T_element>::getLayout(batchSize, systemSize, NULL)), values(createVector(batchSize * systemSize, data))
+  {
+  }
+
+  BatchVector(const std::size_t batchSize, const std::size_t systemSize, const T_element* const data, Context& context) : 
+    layout(detail::BatchLayout<T_element>::getLayout(batchSize, systemSize, &context)), values(createVector(batchSize * systemSize, data))
+  {
+    values.bindContext(context);
+  }
+
+  inline std::size_t batchSize() const
+  {
+    return layout->getBatchSize();
+  }
+
+  inline std::size_t systemSize() const
+  {
+    return layout->getSystemSize();
+  }
+
+  // The elements of all systems
+  inline const Vector<T_element>& getValues() const
+  {
+    return values;
+  }
+
+  const BatchVector operator+(const BatchVector& right) const
+  {
+    return BatchVector(layout, values + right.values);
+  }
+
+  const BatchVector operator-(const BatchVector& right) const
+  {
+    return BatchVector(layout, values - right.values);
+  }
+
+  // Scales each system by the corresponding element of a batchSize vector
+  const BatchVector scaled(const Vector<T_element>& perSystem) const
+  {
+    return BatchVector(layout, values.ele_mul(layout->getSegmentExpand() * perSystem));
+  }
+
+  // Returns a batchSize vector of the dot products of each system
+  const Vector<T_element> dot(const BatchVector& right) const
+  {
+    assert(batchSize() == right.batchSize() && systemSize() == right.systemSize());
+    return layout->getSegmentSum() * values.ele_mul(right.values);
+  }
+};
+
+template<typename T_element>
+class BatchMatrix
+{
+private:
+  boost::shared_ptr< const detail::BatchLayout<T_element> > layout;
+  Matrix<T_element> blockDiagonal;
+
+  static detail::EntryStream<T_element> createStream(const std::size_t batchSize, const std::size_t systemSize, 
+                                                      const int* const rowPtr, const int* const colInd, const T_element* const values)
+  {
+    const std::size_t nnz = rowPtr[systemSize];
+    detail::EntryStream<T_element> stream(batchSize * systemSize, batchSize * systemSize);
+
+    for(std::size_t system = 0; system < batchSize; ++system)
+    {
+      const std::size_t offset = system * systemSize;
+
+      for(std::size_t row = 0; row < systemSize; ++row)
+        for(int valPtr = rowPtr[row]; valPtr < rowPtr[row+1]; ++valPtr)
+          stream.add(offset + row, offset + colInd[valPtr], values[system * nnz + valPtr]);
+    }
+
+    return stream;
+  }
+
+  void initialise(const int* const rowPtr, const int* const colInd, const T_element* const values, Context* const context)
+  {
+    const std::size_t batchSize = layout->getBatchSize();
+    const std::size_t systemSize = layout->getSystemSize();
+    detail::EntryStream<T_element> stream(createStream(batchSize, systemSize, rowPtr, colInd, values));
+    blockDiagonal = detail::BatchLayout<T_element>::createMatrix(stream, context);
+  }
+
+public:
+  // The systems share one sparsity pattern, given in compressed row storage
+  // by rowPtr (systemSize+1 entries) and colInd. The values of system i are
+  // values[i*nnz] to values[(i+1)*nnz - 1].
+  BatchMatrix(const std::size_t batchSize, const std::size_t systemSize, const int* const rowPtr, const int* const colInd, const T_element* const values) :
+    layout(detail::BatchLayout<T_element>::getLayout(batchSize, systemSize, NULL))
+  {
+    initialise(rowPtr, colInd, values, NULL);
+  }
+
+  BatchMatrix(const std::size_t batchSize, const std::size_t systemSize, const int* const rowPtr, const int* const colInd, const T_element* const values, Context& context) :
+    layout(detail::BatchLayout<T_element>::getLayout(batchSize, systemSize, &context))
+  {
+    initialise(rowPtr, colInd, values, &context);
+  }
+
+  inline std::size_t batchSize() const
+  {
+    return layout->getBatchSize();
+  }
+
+  inline std::size_t systemSize() const
+  {
+    return layout->getSystemSize();
+  }
+
+  inline const Matrix<T_element>& getBlockDiagonal() const
+  {
+    return blockDiagonal;
+  }
+
+  const BatchVector<T_element> operator*(const BatchVector<T_element>& right) const
+  {
+    assert(batchSize() == right.batchSize() && systemSize() == right.systemSize());
+    return BatchVector<T_element>(right.layout, blockDiagonal * right.values);
+  }
+};
+
+}
+#endif
@@ -0,0 +1,186 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef DESOLA_BUFFER_DONATION_HPP
+#define DESOLA_BUFFER_DONATION_HPP
+
+#include <cstddef>
+#include <algorithm>
+#include <map>
+#include <desola/Desola_fwd.hpp>
+
+namespace desola
+{
+
+namespace detail
+{
+
+// Returns the node if each element of its value depends only on the elements at the
+// same index of its operands of the same type, otherwise NULL
+template<typename exprType, typename T_element>
+class ElementwiseNodeMatcher : public ExpressionNodeVisitor<T_element>
+{
+private:
+  ExprNode<exprType, T_element>* matched;
+
+  void capture(ExprNode<exprType, T_element>& e)
+  {
+    matched = &e;
+  }
+
+  template<typename T_otherType>
+  void capture(ExprNode<T_otherType, T_element>& e)
+  {
+  }
+
+  ElementwiseNodeMatcher() : matched(NULL)
+  {
+  }
+
+public:
+  static ExprNode<exprType, T_element>* match(ExpressionNode<T_element>& node)
+  {
+    ElementwiseNodeMatcher matcher;
+    node.accept(matcher);
+    return matcher.matched;
+  }
+
+  virtual void visit(Pairwise<scalar, T_element>& e) {}
+  virtual void visit(Pairwise<vector, T_element>& e) { capture(e); }
+  virtual void visit(Pairwise<matrix, T_element>& e) { capture(e); }
+  virtual void visit(ScalarPiecewise<scalar, T_element>& e) {}
+  virtual void visit(ScalarPiecewise<vector, T_element>& e) { capture(e); }
+  virtual void visit(ScalarPiecewise<matrix, T_element>& e) { capture(e); }
+  virtual void visit(MatrixMult<T_element>& e) {}
+  virtual void visit(MatrixVectorMult<T_element>& e) {}
+  virtual void visit(TransposeMatrixVectorMult<T_element>& e) {}
+  virtual void visit(VectorDot<T_element>& e) {}
+  virtual void visit(VectorCross<T_element>& e) {}
+  virtual void visit(VectorTwoNorm<T_element>& e) {}
+  virtual void visit(VectorAxpby<T_element>& e) { capture(e); }
+  virtual void visit(MatrixTranspose<T_element>& e) {}
+  virtual void visit(ElementGet<vector, T_element>& e) {}
+  virtual void visit(ElementGet<matrix, T_element>& e) {}
+  virtual void visit(ElementSet<vector, T_element>& e) {}
+  virtual void visit(ElementSet<matrix, T_element>& e) {}
+  virtual void visit(Slice<vector, T_element>& e) {}
+  virtual void visit(Slice<matrix, T_element>& e) {}
+  virtual void visit(Literal<scalar, T_element>& e) {}
+  virtual void visit(Literal<vector, T_element>& e) {}
+  virtual void visit(Literal<matrix, T_element>& e) {}
+  virtual void visit(Negate<scalar, T_element>& e) {}
+  virtual void visit(Negate<vector, T_element>& e) { capture(e); }
+  virtual void visit(Negate<matrix, T_element>& e) { capture(e); }
+  virtual void visit(Absolute<T_element>& e) {}
+  virtual void visit(SquareRoot<T_element>& e) {}
+};
+
+// Lets results be computed into the storage of input literals which die with the
+// evaluation, rather than into newly allocated arrays. An input may donate its
+// storage when no variable requires it and its only user is an elementwise node
+// whose result is held by a literal of the same shape. The generated loops read
+// each input element before writing the result element at the same index, and
+// nothing else reads the input, so the two literals can share one array. The
+// input keeps a borrowed pointer to it until it is freed.
+//
+// Donation must happen before the result literals are allocated.
+template<typename T_element>
+class BufferDonor : public InternalVectorVisitor<T_element>, public InternalMatrixVisitor<T_element>
+{
+private:
+  ConventionalVector<T_element>* conventionalVector;
+  ConventionalMatrix<T_element>* conventionalMatrix;
+
+  BufferDonor() : conventionalVector(NULL), conventionalMatrix(NULL)
+  {
+  }
+
+  virtual void visit(ConventionalVector<T_element>& value)
+  {
+    conventionalVector = &value;
+  }
+
+  virtual void visit(ConventionalMatrix<T_element>& value)
+  {
+    conventionalMatrix = &value;
+  }
+
+  virtual void visit(CRSMatrix<T_element>& value)
+  {
+  }
+
+  static bool donateStorage(InternalVector<T_element>& donor, InternalVector<T_element>& recipient)
+  {
+    BufferDonor donorFinder, recipientFinder;
+    donor.accept(donorFinder);
+    recipient.accept(recipientFinder);
+
+    return donorFinder.conventionalVector != NULL && recipientFinder.conventionalVector != NULL &&
+      donorFinder.conventionalVector->donateStorage(*recipientFinder.conventionalVector);
+  }
+
+  static bool donateStorage(InternalMatrix<T_element>& donor, InternalMatrix<T_element>& recipient)
+  {
+    BufferDonor donorFinder, recipientFinder;
+    donor.accept(donorFinder);
+    recipient.accept(recipientFinder);
+
+    return donorFinder.conventionalMatrix != NULL && recipientFinder.conventionalMatrix != NULL &&
+      donorFinder.conventionalMatrix->donateStorage(*recipientFinder.conventionalMatrix);
+  }
+
+public:
+  // Takes the mapping from evaluated nodes to the literals holding their values, in
+  // which input literals map to themselves. Returns the number of donated arrays.
+  template<typename exprType>
+  static std::size_t donate(const std::map<ExprNode<exprType, T_element>*, Literal<exprType, T_element>*>& map)
+  {
+    typedef typename std::map<ExprNode<exprType, T_element>*, Literal<exprType, T_element>*>::const_iterator MapIterator;
+    std::size_t donated = 0;
+
+    for(MapIterator inputIter = map.begin(); inputIter != map.end(); ++inputIter)
+    {
+      Literal<exprType, T_element>* const input = inputIter->second;
+
+      if (inputIter->first != input || input->getExternalRequiredByCount() != 0)
+        continue;
+
+      // The user may hold the input as more than one operand
+      const typename ExpressionNode<T_element>::NodeList users(input->getInternalRequiredBy());
+
+      if (users.empty() || static_cast<std::size_t>(std::count(users.begin(), users.end(), *users.begin())) != users.size())
+        continue;
+
+      ExprNode<exprType, T_element>* const user = ElementwiseNodeMatcher<exprType, T_element>::match(**users.begin());
+
+      if (user == NULL)
+        continue;
+
+      const MapIterator resultIter = map.find(user);
+
+      if (resultIter != map.end() && resultIter->second != user && donateStorage(input->getValue(), resultIter->second->getValue()))
+        ++donated;
+    }
+
+    return donated;
+  }
+};
+
+}
+
+}
+#endif
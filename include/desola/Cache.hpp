@@ -26,19 +26,26 @@ namespace desola
 namespace detail
 {
 	
+// Caches are flushed when the configuration they are registered with changes
 class Cache
 {
+private:
+  Cache(const Cache&);
+  Cache& operator=(const Cache&);
+
+  ConfigurationManager& configurationManager;
+
 public:
-  Cache()
+  Cache(ConfigurationManager& c) : configurationManager(c)
   {
-    ConfigurationManager::getConfigurationManager().registerCache(*this);
+    configurationManager.registerCache(*this);
   }
 
   virtual void flush() =0;
 
   virtual ~Cache()
   {
-    ConfigurationManager::getConfigurationManager().unregisterCache(*this);
+    configurationManager.unregisterCache(*this);
   }
 };
 
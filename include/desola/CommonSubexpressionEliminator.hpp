@@ -0,0 +1,198 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+
+#ifndef DESOLA_COMMON_SUBEXPRESSION_ELIMINATOR_HPP
+#define DESOLA_COMMON_SUBEXPRESSION_ELIMINATOR_HPP
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include <desola/Desola_fwd.hpp>
+#include <desola/HashingVisitor.hpp>
+
+namespace desola
+{
+
+namespace detail
+{
+
+// Redirects all users of a node to a node of the same type
+template<typename T_element>
+class SubexpressionReplacer : public ExpressionNodeTypeVisitor<T_element>
+{
+private:
+  ExpressionNode<T_element>& replacement;
+
+  template<typename exprType>
+  void replace(ExprNode<exprType, T_element>& e)
+  {
+    e.replace(static_cast<ExprNode<exprType, T_element>&>(replacement));
+  }
+
+public:
+  SubexpressionReplacer(ExpressionNode<T_element>& r) : replacement(r)
+  {
+  }
+
+  virtual void visit(ExprNode<scalar, T_element>& e)
+  {
+    replace(e);
+  }
+
+  virtual void visit(ExprNode<vector, T_element>& e)
+  {
+    replace(e);
+  }
+
+  virtual void visit(ExprNode<matrix, T_element>& e)
+  {
+    replace(e);
+  }
+};
+
+// Merges structurally identical nodes in a topologically sorted node list.
+// Nodes are visited in order so that once two nodes are merged, their users
+// can be matched in turn. Replaced nodes are removed from the list and are
+// freed as soon as nothing refers to them.
+template<typename T_element>
+class CommonSubexpressionEliminator
+{
+private:
+  struct Entry
+  {
+    ExpressionNodeKey key;
+    std::size_t position;
+  };
+
+  // Candidates are bucketed by hash, so each node is only compared against nodes that may match it
+  typedef std::map<std::size_t, std::vector<Entry> > EntryMap;
+
+  int eliminated;
+  int eliminatedMatrixVectorMults;
+  int eliminatedDots;
+
+  static void replace(ExpressionNode<T_element>& previous, ExpressionNode<T_element>& next)
+  {
+    SubexpressionReplacer<T_element> replacer(next);
+    previous.accept(replacer);
+  }
+
+  template<typename T_node>
+  static bool isA(ExpressionNode<T_element>& node)
+  {
+    return ExpressionNodeMatcher<T_node, T_element>::match(node) != NULL;
+  }
+
+  void countEliminated(ExpressionNode<T_element>& node)
+  {
+    ++eliminated;
+
+    if (isA< MatrixVectorMult<T_element> >(node) || isA< TransposeMatrixVectorMult<T_element> >(node))
+      ++eliminatedMatrixVectorMults;
+
+    if (isA< VectorDot<T_element> >(node) || isA< VectorTwoNorm<T_element> >(node))
+      ++eliminatedDots;
+  }
+
+public:
+  CommonSubexpressionEliminator() : eliminated(0), eliminatedMatrixVectorMults(0), eliminatedDots(0)
+  {
+  }
+
+  // The preserved node is never replaced, since the caller may still be using it. Nodes
+  // belonging to other graphs are never merged.
+  void eliminate(std::vector<ExpressionNode<T_element>*>& nodes, ExpressionNode<T_element>& preserved)
+  {
+    EntryMap entries;
+    std::size_t out = 0;
+
+    for(std::size_t in = 0; in < nodes.size(); ++in)
+    {
+      ExpressionNode<T_element>* const node = nodes[in];
+      HashingVisitor<T_element> hasher;
+
+      if (preserved.sharesGraphWith(node))
+        node->accept(hasher);
+
+      if (!hasher.isHashable())
+      {
+        nodes[out++] = node;
+        continue;
+      }
+
+      std::vector<Entry>& bucket(entries[hasher.getHash()]);
+      const Entry* match = NULL;
+
+      for(typename std::vector<Entry>::const_iterator entry = bucket.begin(); entry != bucket.end() && match == NULL; ++entry)
+      {
+        if (entry->key == hasher.getKey())
+          match = &(*entry);
+      }
+
+      if (match == NULL)
+      {
+        Entry entry;
+        entry.key = hasher.getKey();
+        entry.position = out;
+        bucket.push_back(entry);
+
+        nodes[out++] = node;
+      }
+      else
+      {
+        ExpressionNode<T_element>* const original = nodes[match->position];
+        countEliminated(*node);
+
+        // The original has the same operands, so the preserved node may safely take its position.
+        // Earlier users of the original keep keys naming it, which can only hide later matches.
+        if (node == &preserved)
+        {
+          nodes[match->position] = node;
+          replace(*original, *node);
+        }
+        else
+        {
+          replace(*node, *original);
+        }
+      }
+    }
+
+    nodes.resize(out);
+  }
+
+  int getEliminatedCount() const
+  {
+    return eliminated;
+  }
+
+  int getEliminatedMatrixVectorMultCount() const
+  {
+    return eliminatedMatrixVectorMults;
+  }
+
+  int getEliminatedDotCount() const
+  {
+    return eliminatedDots;
+  }
+};
+
+}
+
+}
+
+#endif
@@ -19,6 +19,8 @@
 #define DESOLA_CONFIGURATION_MANAGER_HPP
 
 #include <set>
+#include <cstddef>
+#include <boost/thread/mutex.hpp>
 
 namespace desola
 {
@@ -31,6 +33,7 @@ namespace detail
 class ConfigurationManager
 {
 private:
+  mutable boost::mutex mutex;
   std::set<detail::Cache*> caches;
   bool gcc;
   bool doCodeCaching;
@@ -40,15 +43,26 @@ private:
   bool doLiveness;
   bool doSingleForLoopSparse;
   bool doSparseSpecialisation;
-  static ConfigurationManager configurationManager;
+  std::size_t threadCount;
+  bool doThreadPinning;
+  bool doPipelinedEvaluation;
+  bool doCommonSubexpressionElimination;
+  bool doAlgebraicSimplification;
+  bool doScalarReassociation;
+  bool doBufferDonation;
+  std::size_t maxPendingNodes;
+  std::size_t maxPendingBytes;
+  std::size_t maxPendingDepth;
 
   void flushCaches();
 
   ConfigurationManager(const ConfigurationManager&);
   ConfigurationManager& operator=(const ConfigurationManager&);
-  ConfigurationManager();
 
 public:
+  ConfigurationManager();
+
+  // Returns the configuration of the default context
   static ConfigurationManager& getConfigurationManager();
 
   void registerCache(detail::Cache& cache);
@@ -81,6 +95,56 @@ public:
   void enableSparseSpecialisation(const bool enabled);
   bool sparseSpecialisationEnabled() const;
 
+  // Independent evaluators of a graph may run concurrently on this many threads, but each
+  // generated kernel runs on a single thread. Zero uses one thread per hardware thread.
+  void setThreadCount(const std::size_t threads);
+  std::size_t getThreadCount() const;
+
+  void enableThreadPinning(const bool enabled);
+  bool threadPinningEnabled() const;
+
+  // Evaluations return once queued on the context's execution thread
+  void enablePipelinedEvaluation(const bool enabled);
+  bool pipelinedEvaluationEnabled() const;
+
+  // Structurally identical nodes are merged before each evaluation
+  void enableCommonSubexpressionElimination(const bool enabled);
+  bool commonSubexpressionEliminationEnabled() const;
+
+  // Rewrites such as fusing scaled vector sums into axpby are applied before each evaluation
+  void enableAlgebraicSimplification(const bool enabled);
+  bool algebraicSimplificationEnabled() const;
+
+  // Simplification may also rewrite (x * a) * b as x * (a * b), which changes the rounding of the result
+  void enableScalarReassociation(const bool enabled);
+  bool scalarReassociationEnabled() const;
+
+  // Elementwise results may be computed into the storage of inputs which are no longer required
+  void enableBufferDonation(const bool enabled);
+  bool bufferDonationEnabled() const;
+
+  // Assigning an expression to a variable evaluates it once the unevaluated graph it depends on
+  // exceeds any of these limits, which bounds the memory held by the graph and the size of the
+  // generated code. The byte limit applies to the values of the unevaluated nodes. The node and
+  // byte limits may be exceeded by up to a factor of two. Zero disables a limit.
+  void setMaxPendingNodes(const std::size_t nodes);
+  std::size_t getMaxPendingNodes() const;
+
+  void setMaxPendingBytes(const std::size_t bytes);
+  std::size_t getMaxPendingBytes() const;
+
+  void setMaxPendingDepth(const std::size_t depth);
+  std::size_t getMaxPendingDepth() const;
+
+  // Vector and matrix storage is allocated from a pool shared by all contexts, so these
+  // settings apply to the whole process. Freed arrays are cached up to the limit in bytes.
+  static void setStoragePoolLimit(const std::size_t bytes);
+  static std::size_t getStoragePoolLimit();
+
+  // Large arrays are advised to be backed by transparent huge pages, where supported
+  static void enableHugePages(const bool enabled);
+  static bool hugePagesEnabled();
+
 };
 
 }
@@ -0,0 +1,88 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef DESOLA_CONTEXT_HPP
+#define DESOLA_CONTEXT_HPP
+
+#include <map>
+#include <string>
+#include <typeinfo>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include "ConfigurationManager.hpp"
+#include "StatisticsCollector.hpp"
+#include "TaskScheduler.hpp"
+#include "ExecutionQueue.hpp"
+#include "Cache.hpp"
+
+namespace desola
+{
+
+// A context owns the configuration, statistics, caches and execution queue
+// used to evaluate the values bound to it. Changing the configuration of one
+// context does not flush the caches of another. The evaluation threads are
+// shared by all contexts and take their thread count from the context whose
+// evaluation finds them idle. Values created without a context are unbound:
+// they adopt the context of the values they are combined with, or use the
+// default context. A context must outlive the values bound to it.
+class Context
+{
+private:
+  Context(const Context&);
+  Context& operator=(const Context&);
+
+  static Context defaultContext;
+
+  ConfigurationManager configurationManager;
+  StatisticsCollector statisticsCollector;
+  const boost::shared_ptr<detail::TaskScheduler> scheduler;
+  boost::mutex cacheMutex;
+  std::map< std::string, boost::shared_ptr<detail::Cache> > caches;
+
+  // Declared last so queued work finishes before anything it uses is destroyed
+  detail::ExecutionQueue executionQueue;
+
+public:
+  Context();
+
+  static Context& getDefaultContext();
+
+  ConfigurationManager& getConfigurationManager();
+  const ConfigurationManager& getConfigurationManager() const;
+
+  StatisticsCollector& getStatisticsCollector();
+  const StatisticsCollector& getStatisticsCollector() const;
+
+  detail::TaskScheduler& getTaskScheduler();
+  detail::ExecutionQueue& getExecutionQueue();
+
+  // Caches are created on first use and registered with this context's configuration
+  template<typename CacheType>
+  CacheType& getCache()
+  {
+    boost::mutex::scoped_lock lock(cacheMutex);
+    boost::shared_ptr<detail::Cache>& cache(caches[typeid(CacheType).name()]);
+
+    if (!cache)
+      cache.reset(new CacheType(configurationManager));
+
+    return static_cast<CacheType&>(*cache);
+  }
+};
+
+}
+#endif
@@ -25,6 +25,9 @@
 #include "Cache.hpp"
 #include "ConfigurationManager.hpp"
 #include "StatisticsCollector.hpp"
+#include "TaskScheduler.hpp"
+#include "ExecutionQueue.hpp"
+#include "Context.hpp"
 #include "Exceptions.hpp"
 #include "Traits.hpp"
 #include "ExpressionNode.hpp"
@@ -37,16 +40,24 @@
 #include "MatrixVector.hpp"
 #include "InternalReps.hpp"
 #include "RowLengthStatistics.hpp"
+#include "Reduction.hpp"
 #include "Literal.hpp"
 #include "ExpressionNodeVisitor.hpp"
 #include "ExpressionGraph.hpp"
+#include "AlgebraicSimplifier.hpp"
+#include "CommonSubexpressionEliminator.hpp"
+#include "BufferDonation.hpp"
 #include "EvaluationStrategy.hpp"
+#include "AsyncEvaluation.hpp"
 #include "Evaluator.hpp"
 #include "NullEvaluator.hpp"
 #include "Variable.hpp"
 #include "Scalar.hpp"
+#include "Future.hpp"
 #include "Vector.hpp"
 #include "Matrix.hpp"
+#include "Batch.hpp"
+#include "MultiVector.hpp"
 #include "Printing.hpp"
 
 #include "tg/Desola_tg.hpp"
@@ -65,6 +65,9 @@ template<typename resultType, typename leftType, typename rightType, typename T_
 template<typename exprType, typename T_element> class Literal;
 template<typename exprType, typename T_element> class ElementGet;
 template<typename exprType, typename T_element> class ElementSet;
+template<typename exprType, typename T_element> class Slice;
+template<typename exprType, typename T_element> class ElementAssignment;
+template<typename exprType, typename T_element> class ElementReader;
 template<typename exprType, typename T_element> class Pairwise;
 template<typename exprType, typename T_element> class ScalarPiecewise;
 template<typename T_element> class MatrixMult;
@@ -73,6 +76,7 @@ template<typename T_element> class TransposeMatrixVectorMult;
 template<typename T_element> class VectorDot;
 template<typename T_element> class VectorCross;
 template<typename T_element> class VectorTwoNorm;
+template<typename T_element> class VectorAxpby;
 template<typename T_element> class MatrixTranspose;
 template<typename exprType, typename T_element> class Negate;
 template<typename T_element> class Absolute;
@@ -85,6 +89,8 @@ template<typename T_candidate, typename T_replacement, typename T_element> struc
 template<typename T_element> class ExpressionNodeVisitor;
 template<typename T_element> class ExpressionNodeTypeVisitor;
 template<typename T_element> class LiteralVisitor;
+template<typename T_node, typename T_element> class ExpressionNodeMatcher;
+template<typename T_element> class HashingVisitor;
 
 // Storage Representations
 template<typename T_element> class InternalValue;
@@ -104,7 +110,12 @@ template<typename T_elementType> class InternalMatrixVisitor;
 
 // Expression Tree Evaluation
 template<typename T_element> class EvaluationStrategy;
+template<typename T_element> class AsyncEvaluation;
 template<typename T_element> class LiteralReplacer;
+template<typename T_element> class CommonSubexpressionEliminator;
+template<typename T_element> class AlgebraicSimplifier;
+template<typename T_element> class BufferDonor;
+template<typename exprType, typename T_element> class ElementwiseNodeMatcher;
 template<typename T_element> class Evaluator;
 template<typename T_element> class EvaluatorFactory;
 template<typename T_element> class NullEvaluator;
@@ -112,19 +123,31 @@ template<typename T_element> class NullEvaluatorFactory;
 
 // External Interface
 template<typename T_element> class Variable;
+template<typename T_element> class NodePin;
 template<typename expressionType, typename T_element> class Var;
 
 // Caching
 class Cache;
 
+// Task Scheduling
+class TaskGroup;
+class TaskScheduler;
+class ExecutionTicket;
+class ExecutionQueue;
+
 // Matrix IO
 template <class T> struct entry1;
 template <class T> struct entry2;
+
+// Batched Systems
+template<typename T_element> class EntryStream;
+template<typename T_element> class BatchLayout;
 }
 
 // Configuration and Statistics
 class ConfigurationManager;
 class StatisticsCollector;
+class Context;
 
 // Matrix IO
 template <class T> class harwell_boeing_stream;
@@ -135,7 +158,18 @@ template<typename T> class Maybe;
 template<typename T_element> class Vector;
 template<typename T_element> class Matrix;
 template<typename T_element> class Scalar;
+template<typename T_element> class Future;
 template<typename exprType, typename T_element> class ScalarElement;
+template<typename T_element> class BatchVector;
+template<typename T_element> class BatchMatrix;
+template<typename T_element> class MultiVector;
+
+// Ownership of storage supplied by the caller when constructing a Vector or Matrix
+enum StorageOwnership
+{
+  ADOPT_STORAGE,  // Allocated with new[] and freed by the library once unused
+  BORROW_STORAGE  // Remains owned by the caller, must outlive all uses and is never written to
+};
 
 
 //Exceptions
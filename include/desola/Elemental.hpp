@@ -22,7 +22,9 @@
 #include <cassert>
 #include <map>
 #include <algorithm>
+#include <boost/array.hpp>
 #include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/ref.hpp>
 #include <desola/Desola_fwd.hpp>
 
@@ -58,6 +60,11 @@ public:
     this->getOperand().evaluate();
   }
 
+  virtual boost::shared_ptr< AsyncEvaluation<T_element> > internal_evaluate_async()
+  {
+    return this->getOperand().evaluateAsync();
+  }
+
   virtual T_element getElementValue()
   {
     return this->getOperand().getElementValue(index);
@@ -104,6 +111,24 @@ public:
   { 
     return std::map<ElementIndex<exprType>, const ExprNode<scalar, T_element>*>(assignments.begin(), assignments.end());
   } 
+
+  // Only valid while nothing other than the assigning variable can observe this node
+  void addAssignment(const ElementIndex<exprType>& index, ExprNode<scalar, T_element>& value)
+  {
+    const typename std::map<ElementIndex<exprType>, ExprNode<scalar, T_element>*>::iterator existing = assignments.find(index);
+
+    if (existing == assignments.end())
+    {
+      assignments.insert(std::make_pair(index, &value));
+      this->registerDependency(&value);
+    }
+    else
+    {
+      ExprNode<scalar, T_element>* const previous = existing->second;
+      existing->second = &value;
+      this->replaceDependency(previous, &value);
+    }
+  }
   
   virtual void accept(ExpressionNodeVisitor<T_element>& visitor)
   { 
@@ -127,6 +152,262 @@ public:
   }
 };
 
+inline ElementIndex<vector> getSlicedIndex(const ElementIndex<vector>& offset, const ElementIndex<vector>& stride, const ElementIndex<vector>& index)
+{
+  return ElementIndex<vector>(offset.getRow() + index.getRow() * stride.getRow());
+}
+
+inline ElementIndex<matrix> getSlicedIndex(const ElementIndex<matrix>& offset, const ElementIndex<matrix>& stride, const ElementIndex<matrix>& index)
+{
+  return ElementIndex<matrix>(offset.getRow() + index.getRow() * stride.getRow(), offset.getCol() + index.getCol() * stride.getCol());
+}
+
+inline ElementIndex<vector> getSlicedStride(const ElementIndex<vector>& stride, const ElementIndex<vector>& innerStride)
+{
+  return ElementIndex<vector>(stride.getRow() * innerStride.getRow());
+}
+
+inline ElementIndex<matrix> getSlicedStride(const ElementIndex<matrix>& stride, const ElementIndex<matrix>& innerStride)
+{
+  return ElementIndex<matrix>(stride.getRow() * innerStride.getRow(), stride.getCol() * innerStride.getCol());
+}
+
+// Refers to the elements of a vector or matrix starting at an offset and
+// separated by a stride in each dimension. A slice is computed by indexing
+// its operand, so it need never be stored.
+template<typename exprType, typename T_element>
+class Slice : public UnOp<exprType, exprType, T_element>
+{
+private:
+  const ElementIndex<exprType> offset;
+  const ElementIndex<exprType> stride;
+
+public:
+  Slice(ExprNode<exprType, T_element>& e, const boost::array<std::size_t, ExprDimensions<exprType>::dims>& dims, 
+        const ElementIndex<exprType>& o, const ElementIndex<exprType>& s) : UnOp<exprType, exprType, T_element>(dims, e), offset(o), stride(s)
+  {
+  }
+
+  inline const ElementIndex<exprType>& getOffset() const
+  {
+    return offset;
+  }
+
+  inline const ElementIndex<exprType>& getStride() const
+  {
+    return stride;
+  }
+
+  // Returns the index of the operand element at an index of the slice
+  inline const ElementIndex<exprType> getSourceIndex(const ElementIndex<exprType>& index) const
+  {
+    return getSlicedIndex(offset, stride, index);
+  }
+
+  virtual void accept(ExpressionNodeVisitor<T_element>& visitor)
+  {
+    visitor.visit(*this);
+  }
+
+  virtual Maybe<double> getFlops() const
+  {
+    return 0.0;
+  }
+};
+
+// Applies element assignments without building a chain of element sets, each
+// of which would copy the whole vector or matrix. A literal is written in place
+// and a pending element set is extended, provided that nothing other than the
+// assigning variable and the given number of internal users refers to it.
+template<typename exprType, typename T_element>
+class ElementAssignment : public LiteralVisitor<T_element>, public InternalVectorVisitor<T_element>, public InternalMatrixVisitor<T_element>
+{
+public:
+  typedef std::map<ElementIndex<exprType>, T_element> ValueMap;
+
+private:
+  const ValueMap& values;
+  bool assigned;
+
+  ElementAssignment(const ValueMap& v) : values(v), assigned(false)
+  {
+  }
+
+  static bool isOwned(const ExpressionNode<T_element>& node, const std::size_t internalUsers)
+  {
+    return node.getInternalRequiredByCount() == internalUsers && node.getExternalRequiredByCount() == 1;
+  }
+
+  static std::size_t getOffset(const ElementIndex<vector>& index, const std::size_t cols)
+  {
+    return index.getRow();
+  }
+
+  static std::size_t getOffset(const ElementIndex<matrix>& index, const std::size_t cols)
+  {
+    return index.getRow() * cols + index.getCol();
+  }
+
+  template<typename T_internal>
+  void scatter(T_internal& internal, const std::size_t cols)
+  {
+    if (internal.isBorrowed())
+      return;
+
+    internal.allocate();
+    T_element* const data = internal.getValue();
+
+    for(typename ValueMap::const_iterator valueIter = values.begin(); valueIter != values.end(); ++valueIter)
+      data[getOffset(valueIter->first, cols)] = valueIter->second;
+
+    assigned = true;
+  }
+
+  template<typename T_internal>
+  void visitInternal(T_internal& internal)
+  {
+    internal.waitUntilReady();
+    internal.accept(*this);
+  }
+
+public:
+  static bool assignInPlace(ExprNode<exprType, T_element>& node, const ValueMap& values, const std::size_t internalUsers)
+  {
+    if (!isOwned(node, internalUsers))
+      return false;
+
+    ElementAssignment assignment(values);
+    static_cast<ExpressionNode<T_element>&>(node).accept(assignment);
+    return assignment.assigned;
+  }
+
+  static ElementSet<exprType, T_element>* getExtendable(ExprNode<exprType, T_element>& node, const std::size_t internalUsers)
+  {
+    ElementSet<exprType, T_element>* const elementSet = ExpressionNodeMatcher<ElementSet<exprType, T_element>, T_element>::match(node);
+    return elementSet != NULL && isOwned(*elementSet, internalUsers) ? elementSet : NULL;
+  }
+
+  virtual void visit(Literal<scalar, T_element>& e)
+  {
+  }
+
+  virtual void visit(Literal<vector, T_element>& e)
+  {
+    visitInternal(e.getValue());
+  }
+
+  virtual void visit(Literal<matrix, T_element>& e)
+  {
+    visitInternal(e.getValue());
+  }
+
+  virtual void visit(ConventionalVector<T_element>& v)
+  {
+    scatter(v, 1);
+  }
+
+  virtual void visit(ConventionalMatrix<T_element>& m)
+  {
+    scatter(m, m.getColCount());
+  }
+
+  // The sparsity structure is fixed
+  virtual void visit(CRSMatrix<T_element>& m)
+  {
+  }
+};
+
+// Reads an evaluated value directly from its storage. Matrices are read in
+// row-major order, with the zeros of sparse matrices filled in.
+template<typename exprType, typename T_element>
+class ElementReader : public LiteralVisitor<T_element>, public InternalVectorVisitor<T_element>, public InternalMatrixVisitor<T_element>
+{
+private:
+  T_element* output;
+  const T_element* storage;
+  bool evaluated;
+
+  ElementReader(T_element* const o) : output(o), storage(NULL), evaluated(false)
+  {
+  }
+
+  template<typename T_internal>
+  void visitInternal(T_internal& internal)
+  {
+    internal.waitUntilReady();
+    internal.accept(*this);
+    evaluated = true;
+  }
+
+  void read(ExprNode<exprType, T_element>& node)
+  {
+    static_cast<ExpressionNode<T_element>&>(node).accept(*this);
+    assert(evaluated);
+  }
+
+public:
+  // Valid until the value is next assigned to. Sparse matrices have no dense storage, so give NULL.
+  static const T_element* getStorage(ExprNode<exprType, T_element>& node)
+  {
+    ElementReader reader(NULL);
+    reader.read(node);
+    return reader.storage;
+  }
+
+  static void copy(ExprNode<exprType, T_element>& node, T_element* const output)
+  {
+    ElementReader reader(output);
+    reader.read(node);
+  }
+
+  virtual void visit(Literal<scalar, T_element>& e)
+  {
+  }
+
+  virtual void visit(Literal<vector, T_element>& e)
+  {
+    visitInternal(e.getValue());
+  }
+
+  virtual void visit(Literal<matrix, T_element>& e)
+  {
+    visitInternal(e.getValue());
+  }
+
+  virtual void visit(ConventionalVector<T_element>& v)
+  {
+    storage = v.getValue();
+
+    if (output != NULL)
+      std::copy(storage, storage + v.getRowCount(), output);
+  }
+
+  virtual void visit(ConventionalMatrix<T_element>& m)
+  {
+    storage = m.getValue();
+
+    if (output != NULL)
+      std::copy(storage, storage + m.getRowCount() * m.getColCount(), output);
+  }
+
+  virtual void visit(CRSMatrix<T_element>& m)
+  {
+    if (output != NULL)
+    {
+      const std::size_t cols = m.getColCount();
+      const int* const rowPtr = m.get_row_ptr();
+      const int* const colInd = m.get_col_ind();
+      const T_element* const val = m.get_val();
+
+      std::fill(output, output + m.getRowCount() * cols, T_element());
+
+      for(std::size_t row = 0; row < m.getRowCount(); ++row)
+        for(int index = rowPtr[row]; index < rowPtr[row+1]; ++index)
+          output[row * cols + colInd[index]] = val[index];
+    }
+  }
+};
+
 }
 
 }
@@ -27,6 +27,8 @@
 #include <boost/bind.hpp>
 #include <cassert>
 #include <boost/shared_ptr.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread/mutex.hpp>
 #include <desola/Desola_fwd.hpp>
 
 namespace desola
@@ -35,6 +37,8 @@ namespace desola
 namespace detail
 {
 
+// Literals map to themselves. Replacing them would be a no-op that touches every node requiring
+// them, including nodes of graphs being built concurrently on other threads, so they are skipped.
 template<typename T_element>
 class LiteralReplacer : public ExpressionNodeTypeVisitor<T_element>
 {
@@ -57,21 +61,21 @@ public:
   void visit(ExprNode<scalar, T_element>& expr)
   {
     const typename std::map<ExprNode<scalar, T_element>*, Literal<scalar, T_element>*>::const_iterator i = scalarMap.find(&expr);
-    if (i != scalarMap.end())
+    if (i != scalarMap.end() && i->first != i->second)
       i->first->replace(*(i->second));
   }
 
   void visit(ExprNode<vector, T_element>& expr)
   {
     const typename std::map<ExprNode<vector, T_element>*, Literal<vector, T_element>*>::const_iterator i = vectorMap.find(&expr);
-    if (i != vectorMap.end())
+    if (i != vectorMap.end() && i->first != i->second)
       i->first->replace(*(i->second));
   }
 
   void visit(ExprNode<matrix, T_element>& expr)
   {
     const typename std::map<ExprNode<matrix, T_element>*, Literal<matrix, T_element>*>::const_iterator i = matrixMap.find(&expr);
-    if (i != matrixMap.end())
+    if (i != matrixMap.end() && i->first != i->second)
       i->first->replace(*(i->second));
   }      
 };
@@ -85,10 +89,16 @@ private:
 	
   bool hasEvaluated;
   ExpressionGraph<T_element>& expressionGraph;
+  Context& context;
 
   std::vector< ExpressionNode<T_element>* > sortedUnclaimed;
   std::vector< boost::shared_ptr< Evaluator<T_element> > > evaluators;
   std::map< Evaluator<T_element>*, std::set<ExpressionNode<T_element>*> > claimedMap;
+
+  // Evaluators become runnable tasks once all evaluators they depend on have completed
+  boost::mutex schedulingMutex;
+  std::map< Evaluator<T_element>*, std::size_t > remainingDependencies;
+  std::map< Evaluator<T_element>*, std::vector<Evaluator<T_element>*> > dependents;
 	  
   std::map< ExprNode<scalar, T_element>*, Literal<scalar, T_element>* > scalarMap;
   std::map< ExprNode<vector, T_element>*, Literal<vector, T_element>* > vectorMap;
@@ -132,8 +142,95 @@ private:
     allocateLiteralsHelper(matrixMap);
   }
 
+  // Scalars are held by value, so only vector and matrix storage is donated
+  void donateBuffers()
+  {
+    if (context.getConfigurationManager().bufferDonationEnabled())
+    {
+      const std::size_t donated = BufferDonor<T_element>::donate(vectorMap) + BufferDonor<T_element>::donate(matrixMap);
+
+      if (donated > 0)
+        context.getStatisticsCollector().addDonations(donated);
+    }
+  }
+
+  // Literals which were already evaluated map to themselves, the others hold results
+  template<typename exprType>
+  static void setProducerHelper(const std::map<ExprNode<exprType, T_element>*, Literal<exprType, T_element>*>& map, const boost::shared_ptr<ExecutionTicket>& ticket)
+  {
+    for(typename std::map<ExprNode<exprType, T_element>*, Literal<exprType, T_element>*>::const_iterator mapIter = map.begin(); mapIter != map.end(); ++mapIter)
+      if (mapIter->first != mapIter->second)
+        mapIter->second->getValue().setProducer(ticket);
+  }
+
+  template<typename exprType>
+  static void waitForInputsHelper(const std::map<ExprNode<exprType, T_element>*, Literal<exprType, T_element>*>& map)
+  {
+    for(typename std::map<ExprNode<exprType, T_element>*, Literal<exprType, T_element>*>::const_iterator mapIter = map.begin(); mapIter != map.end(); ++mapIter)
+      if (mapIter->first == mapIter->second)
+        mapIter->second->getValue().waitUntilReady();
+  }
+
+  template<typename exprType>
+  static void getLiteralsHelper(const std::map<ExprNode<exprType, T_element>*, Literal<exprType, T_element>*>& map, std::vector<ExpressionNode<T_element>*>& literals)
+  {
+    for(typename std::map<ExprNode<exprType, T_element>*, Literal<exprType, T_element>*>::const_iterator mapIter = map.begin(); mapIter != map.end(); ++mapIter)
+      literals.push_back(mapIter->second);
+  }
+
+  void computeEvaluatorDependencies()
+  {
+    typedef typename std::map< Evaluator<T_element>*, std::set<ExpressionNode<T_element>*> >::const_iterator ClaimedIterator;
+    std::map<ExpressionNode<T_element>*, Evaluator<T_element>*> owners;
+
+    for(ClaimedIterator claimedIter = claimedMap.begin(); claimedIter != claimedMap.end(); ++claimedIter)
+      for(typename std::set<ExpressionNode<T_element>*>::const_iterator nodeIter = claimedIter->second.begin(); nodeIter != claimedIter->second.end(); ++nodeIter)
+        owners[*nodeIter] = claimedIter->first;
+
+    for(ClaimedIterator claimedIter = claimedMap.begin(); claimedIter != claimedMap.end(); ++claimedIter)
+    {
+      std::set<Evaluator<T_element>*> required;
+
+      for(typename std::set<ExpressionNode<T_element>*>::const_iterator nodeIter = claimedIter->second.begin(); nodeIter != claimedIter->second.end(); ++nodeIter)
+      {
+        const typename ExpressionNode<T_element>::NodeList& nodeDeps((*nodeIter)->getDependencies());
+
+        for(typename ExpressionNode<T_element>::NodeList::const_iterator depIter = nodeDeps.begin(); depIter != nodeDeps.end(); ++depIter)
+        {
+          const typename std::map<ExpressionNode<T_element>*, Evaluator<T_element>*>::const_iterator owner = owners.find(*depIter);
+
+          if (owner != owners.end() && owner->second != claimedIter->first)
+            required.insert(owner->second);
+        }
+      }
+
+      remainingDependencies[claimedIter->first] = required.size();
+
+      for(typename std::set<Evaluator<T_element>*>::const_iterator requiredIter = required.begin(); requiredIter != required.end(); ++requiredIter)
+        dependents[*requiredIter].push_back(claimedIter->first);
+    }
+  }
+
+  void runEvaluator(TaskScheduler& scheduler, TaskGroup& group, Evaluator<T_element>* const evaluator)
+  {
+    evaluator->evaluate();
+
+    std::vector<Evaluator<T_element>*> ready;
+    {
+      boost::mutex::scoped_lock lock(schedulingMutex);
+      const std::vector<Evaluator<T_element>*>& waiting(dependents[evaluator]);
+
+      for(typename std::vector<Evaluator<T_element>*>::const_iterator waitingIter = waiting.begin(); waitingIter != waiting.end(); ++waitingIter)
+        if (--remainingDependencies[*waitingIter] == 0)
+          ready.push_back(*waitingIter);
+    }
+
+    for(typename std::vector<Evaluator<T_element>*>::const_iterator readyIter = ready.begin(); readyIter != ready.end(); ++readyIter)
+      scheduler.submit(group, boost::bind(&EvaluationStrategy::runEvaluator, this, boost::ref(scheduler), boost::ref(group), *readyIter));
+  }
+
 public:
-  EvaluationStrategy(ExpressionGraph<T_element>& graph) : hasEvaluated(false), expressionGraph(graph), 
+  EvaluationStrategy(ExpressionGraph<T_element>& graph, Context& c) : hasEvaluated(false), expressionGraph(graph), context(c),
     sortedUnclaimed(graph.sortedNodesBegin(), graph.sortedNodesEnd())
   {
     NullEvaluatorFactory<T_element> nullEvaluatorFactory;
@@ -161,20 +258,82 @@ public:
     }
   }
   
-  void execute()
+  // Evaluation is split into stages so the evaluators can be run on another thread. Preparation
+  // and publication modify the expression graph and must happen on the thread that built it.
+  void prepare()
   {
     assert(sortedUnclaimed.empty());
-    
-    if (!hasEvaluated)
+    assert(!hasEvaluated);
+
+    hasEvaluated=true;
+    donateBuffers();
+    allocateLiterals();
+    computeEvaluatorDependencies();
+  }
+
+  void run()
+  {
+    assert(hasEvaluated);
+
+    TaskScheduler& scheduler(context.getTaskScheduler());
+    TaskGroup group(scheduler, context.getConfigurationManager());
+
+    // Submitted evaluators may update the dependency counts, so they are only read beforehand
+    std::vector<Evaluator<T_element>*> ready;
+
+    for(typename std::vector< boost::shared_ptr< Evaluator<T_element> > >::iterator evaluatorIterator = evaluators.begin(); evaluatorIterator != evaluators.end(); ++evaluatorIterator)
     {
-      hasEvaluated=true;
+      if (remainingDependencies[evaluatorIterator->get()] == 0)
+        ready.push_back(evaluatorIterator->get());
+    }
 
-      allocateLiterals();
-      LiteralReplacer<T_element> replacer(scalarMap, vectorMap, matrixMap);
-      for(typename std::vector< boost::shared_ptr< Evaluator<T_element> > >::iterator evaluatorIterator = evaluators.begin(); evaluatorIterator != evaluators.end(); ++evaluatorIterator)
-        (*evaluatorIterator)->evaluate();
+    for(typename std::vector<Evaluator<T_element>*>::const_iterator readyIter = ready.begin(); readyIter != ready.end(); ++readyIter)
+      scheduler.submit(group, boost::bind(&EvaluationStrategy::runEvaluator, this, boost::ref(scheduler), boost::ref(group), *readyIter));
 
-      expressionGraph.accept(replacer);
+    scheduler.wait(group);
+  }
+
+  void publish()
+  {
+    assert(hasEvaluated);
+
+    LiteralReplacer<T_element> replacer(scalarMap, vectorMap, matrixMap);
+    expressionGraph.accept(replacer);
+  }
+
+  // Marks the results as computed by a queued evaluation, so they may be published before it runs
+  void setProducer(const boost::shared_ptr<ExecutionTicket>& ticket)
+  {
+    setProducerHelper(scalarMap, ticket);
+    setProducerHelper(vectorMap, ticket);
+    setProducerHelper(matrixMap, ticket);
+  }
+
+  // Waits for inputs computed by other queued evaluations
+  void waitForInputs() const
+  {
+    waitForInputsHelper(scalarMap);
+    waitForInputsHelper(vectorMap);
+    waitForInputsHelper(matrixMap);
+  }
+
+  // Returns the literals read and written by the evaluators
+  std::vector<ExpressionNode<T_element>*> getLiterals() const
+  {
+    std::vector<ExpressionNode<T_element>*> literals;
+    getLiteralsHelper(scalarMap, literals);
+    getLiteralsHelper(vectorMap, literals);
+    getLiteralsHelper(matrixMap, literals);
+    return literals;
+  }
+  
+  void execute()
+  {
+    if (!hasEvaluated)
+    {
+      prepare();
+      run();
+      publish();
     }
   }
  
@@ -183,16 +342,7 @@ public:
     assert(claimedMap.find(&evaluator) != claimedMap.end());
 
     // It's an output if it has nodes depending on it that are not evaluated by the evaluator
-    const std::vector<ExpressionNode<T_element>*> internal_reqBy(node.getInternalRequiredBy());
-    const std::set<ExpressionNode<T_element>*>& claimed = claimedMap.find(&evaluator)->second;
-       
-    for(typename std::vector<ExpressionNode<T_element>*>::const_iterator iterator=internal_reqBy.begin(); iterator!=internal_reqBy.end(); ++iterator)
-    {
-      if (claimed.find(*iterator) == claimed.end())
-        return true;
-    }
-	
-    return false;
+    return node.isRequiredOutside(claimedMap.find(&evaluator)->second);
   }
 
   // Given a pointer to a Literal, these methods return whether or not the literal contains actual data. At
@@ -218,6 +368,11 @@ public:
     return expressionGraph;
   }
 
+  inline Context& getContext()
+  {
+    return context;
+  }
+
   void addEvaluatedExprMapping(ExprNode<scalar, T_element>* const e, Literal<scalar, T_element>* const l)
   {
     assert(e != NULL);
@@ -0,0 +1,91 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef DESOLA_EXECUTION_QUEUE_HPP
+#define DESOLA_EXECUTION_QUEUE_HPP
+
+#include <deque>
+#include <utility>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/atomic.hpp>
+
+namespace desola
+{
+
+namespace detail
+{
+
+// Completed once the task it was submitted with has run
+class ExecutionTicket
+{
+private:
+  ExecutionTicket(const ExecutionTicket&);
+  ExecutionTicket& operator=(const ExecutionTicket&);
+
+  boost::mutex mutex;
+  boost::condition_variable finished;
+  boost::atomic<bool> done;
+  boost::exception_ptr error;
+
+public:
+  ExecutionTicket();
+
+  void complete(const boost::exception_ptr& e);
+  bool isComplete() const;
+  void wait();
+
+  // Only valid once the ticket is complete
+  boost::exception_ptr getError() const;
+};
+
+// A dedicated thread which runs tasks in the order they are submitted. The
+// thread is started on first use. Remaining tasks are run before destruction.
+class ExecutionQueue
+{
+public:
+  typedef boost::function<void ()> Task;
+
+private:
+  ExecutionQueue(const ExecutionQueue&);
+  ExecutionQueue& operator=(const ExecutionQueue&);
+
+  boost::mutex mutex;
+  boost::condition_variable workAvailable;
+  std::deque< std::pair< Task, boost::shared_ptr<ExecutionTicket> > > tasks;
+  boost::scoped_ptr<boost::thread> thread;
+  bool stopping;
+
+  void run();
+
+public:
+  ExecutionQueue();
+
+  void submit(const Task& task, const boost::shared_ptr<ExecutionTicket>& ticket);
+  ~ExecutionQueue();
+};
+
+}
+
+}
+
+#endif
@@ -99,6 +99,11 @@ public:
     assert(false);
     return T_elementType();
   }
+
+  virtual std::size_t getValueBytes() const
+  {
+    return sizeof(T_elementType);
+  }
 };
 
 template<typename T_elementType>
@@ -137,6 +142,11 @@ public:
     assert(false);
     return T_elementType();
   }			   
+
+  virtual std::size_t getValueBytes() const
+  {
+    return dimensions[0] * sizeof(T_elementType);
+  }
 };
 
 template<typename T_elementType>
@@ -185,6 +195,11 @@ public:
     assert(false);
     return T_elementType();
   }
+
+  virtual std::size_t getValueBytes() const
+  {
+    return dimensions[0] * dimensions[1] * sizeof(T_elementType);
+  }
 };
 
 template<typename exprType>
@@ -63,7 +63,7 @@ private:
 
   static void setDefaultAnnotation(ExpressionNode<T_element>* const node)
   {
-    if (node->getExternalRequiredBy().empty())
+    if (node->getExternalRequiredByCount() == 0)
     {
       node->setEvaluationDirective(NO_EVALUATE);
     }
@@ -133,9 +133,9 @@ public:
     return std::accumulate(exprVector.begin(), exprVector.end(), Maybe<double>(0.0), accumulateFlops);
   }
    
-  boost::shared_ptr<EvaluationStrategy<T_element> > createEvaluationStrategy()
+  boost::shared_ptr<EvaluationStrategy<T_element> > createEvaluationStrategy(Context& context)
   {
-    return boost::shared_ptr<EvaluationStrategy<T_element> >(new EvaluationStrategy<T_element>(*this));
+    return boost::shared_ptr<EvaluationStrategy<T_element> >(new EvaluationStrategy<T_element>(*this, context));
   }
 };
 
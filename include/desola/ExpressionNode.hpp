@@ -24,12 +24,21 @@
 #include <vector>
 #include <algorithm>
 #include <iterator>
+#include <limits>
 #include <memory>
+#include <numeric>
 #include <boost/shared_ptr.hpp>
 #include <boost/bind.hpp>
 #include <boost/ref.hpp>
 #include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/atomic.hpp>
+#include <sys/time.h>
 #include <desola/Desola_fwd.hpp>
+#include <desola/Exceptions.hpp>
+#include <desola/NodePool.hpp>
+#include <desola/SmallVector.hpp>
 #include <desola/tg/Desola_tg_fwd.hpp>
 #include <desola/profiling/Desola_profiling_fwd.hpp>
 
@@ -42,16 +51,53 @@ namespace detail
 template<typename T_element>
 class ExpressionNode
 {
+public:
+  typedef SmallVector<ExpressionNode*, 2> NodeList;
+  typedef SmallVector<const Variable<T_element>*, 2> VariableList;
+
 private:
   // Forbid copying and assignment
   ExpressionNode(const ExpressionNode&);
   ExpressionNode& operator=(const ExpressionNode&);
   
   EvaluationDirective evaluationDirective;
-  std::set< PExpressionNodeRef<T_element> > monitors;
-  std::multiset<const Variable<T_element>*> external_reqBy;
-  std::vector<ExpressionNode*> internal_reqBy;
-  std::vector<ExpressionNode*> deps;
+  const boost::thread::id creator;
+  Context* context;
+  std::vector< PExpressionNodeRef<T_element> > monitors;
+  VariableList external_reqBy;
+  NodeList internal_reqBy;
+  NodeList deps;
+
+  // Upper bounds on the unevaluated nodes this node depends on, used to enforce the evaluation
+  // budget. Nodes reached along several paths are counted once per path. The node counts and
+  // depths include this node, while the byte count only covers its unevaluated dependencies.
+  std::size_t pendingNodes;
+  std::size_t pendingDepth;
+  std::size_t pendingBytes;
+
+  // The largest exact counts measured for this node or any of its dependencies. Measuring walks
+  // the whole unevaluated graph, so it is only repeated once an estimate has doubled since.
+  std::size_t measuredNodes;
+  std::size_t measuredBytes;
+
+  // Every node ranks above its dependencies, so ordering by rank is a topological order.
+  // Literals have rank zero.
+  std::size_t rank;
+
+  // Traversals mark the nodes of their own graph with a fresh value instead of building a
+  // visited set. Nodes shared with other graphs are never marked.
+  std::size_t visitMark;
+  static boost::atomic<std::size_t> nextVisitMark;
+
+  // Nodes such as matrix literals may be shared between expression graphs built on different
+  // threads, so the required-by lists are protected by a pool of locks keyed on node address.
+  static const std::size_t trackingLockCount = 64;
+  static boost::mutex trackingLocks[trackingLockCount];
+
+  static boost::mutex& getTrackingLock(const ExpressionNode* const node)
+  {
+    return trackingLocks[(reinterpret_cast<std::size_t>(node) / sizeof(void*)) % trackingLockCount];
+  }
 
   template<typename exprType>
   static void updateVariable(const Variable<T_element>* variable, ExprNode<exprType, T_element>& previous, ExprNode<exprType, T_element>& next)
@@ -65,57 +111,255 @@ private:
     expressionNode->update(previous, next);
   }
 
-  void checkSelfDestruct()
+  inline bool isUnused() const
   {
-    if(internal_reqBy.empty() && external_reqBy.empty())
+    return internal_reqBy.empty() && external_reqBy.empty();
+  }
+
+  static std::size_t addSaturating(const std::size_t a, const std::size_t b)
+  {
+    return a > std::numeric_limits<std::size_t>::max() - b ? std::numeric_limits<std::size_t>::max() : a + b;
+  }
+
+  // Literals have no dependencies and are never pending
+  void addPending(const ExpressionNode& dependency)
+  {
+    if (pendingNodes == 0)
+      pendingNodes = pendingDepth = 1;
+
+    pendingNodes = addSaturating(pendingNodes, dependency.pendingNodes);
+    pendingDepth = std::max(pendingDepth, addSaturating(dependency.pendingDepth, 1));
+    pendingBytes = addSaturating(pendingBytes, dependency.pendingBytes);
+
+    if (dependency.pendingNodes > 0)
+      pendingBytes = addSaturating(pendingBytes, dependency.getValueBytes());
+
+    measuredNodes = std::max(measuredNodes, dependency.measuredNodes);
+    measuredBytes = std::max(measuredBytes, dependency.measuredBytes);
+  }
+
+  // Replaces the node and byte estimates with exact counts, without recursing
+  void measurePending()
+  {
+    const std::size_t mark = newVisitMark();
+    std::vector<ExpressionNode*> stack(deps.begin(), deps.end());
+    pendingNodes = 1;
+    pendingBytes = 0;
+
+    while(!stack.empty())
     {
-      typedef typename std::vector<ExpressionNode*>::iterator Iterator;
-      for(Iterator i = deps.begin(); i != deps.end(); ++i)
-        (*i)->unregisterRequiredBy(this);
+      ExpressionNode* const node = stack.back();
+      stack.pop_back();
+
+      if (node->pendingNodes > 0 && sharesGraphWith(node) && node->visitMark != mark)
+      {
+        node->visitMark = mark;
+        ++pendingNodes;
+        pendingBytes = addSaturating(pendingBytes, node->getValueBytes());
+        stack.insert(stack.end(), node->deps.begin(), node->deps.end());
+      }
+    }
 
-      delete this;
+    measuredNodes = std::max(measuredNodes, pendingNodes);
+    measuredBytes = std::max(measuredBytes, pendingBytes);
+  }
+
+  bool estimatesDoubledSinceMeasured() const
+  {
+    return pendingNodes / 2 > measuredNodes || pendingBytes / 2 > measuredBytes;
+  }
+
+  bool exceedsBudget(const ConfigurationManager& configurationManager) const
+  {
+    const std::size_t maxNodes = configurationManager.getMaxPendingNodes();
+    const std::size_t maxBytes = configurationManager.getMaxPendingBytes();
+    const std::size_t maxDepth = configurationManager.getMaxPendingDepth();
+
+    return (maxNodes != 0 && pendingNodes > maxNodes) || (maxDepth != 0 && pendingDepth > maxDepth) ||
+      (maxBytes != 0 && addSaturating(pendingBytes, getValueBytes()) > maxBytes);
+  }
+
+  // Must be called without holding this node's tracking lock. Dependencies left unused are freed
+  // from a worklist since unevaluated chains can be too deep to unwind recursively.
+  void selfDestruct()
+  {
+    std::vector<ExpressionNode*> unused(1, this);
+
+    while(!unused.empty())
+    {
+      ExpressionNode* const node = unused.back();
+      unused.pop_back();
+
+      for(typename NodeList::iterator i = node->deps.begin(); i != node->deps.end(); ++i)
+      {
+        if ((*i)->removeRequiredBy(node))
+          unused.push_back(*i);
+      }
+
+      delete node;
     }
   }
 
-  static void getLeavesHelper(std::set<ExpressionNode*>& visited, std::vector<ExpressionNode*>& leaves, ExpressionNode* const node)
+  void checkSelfDestruct()
   {
-    if (visited.insert(node).second)
+    bool unused;
     {
-      if (node->internal_reqBy.empty())
-        leaves.push_back(node);
+      boost::mutex::scoped_lock lock(getTrackingLock(this));
+      unused = isUnused();
+    }
+
+    if (unused)
+      selfDestruct();
+  }
+
+  // Only literals have no dependencies. A literal never gains any, and other nodes never lose
+  // theirs, so this may be checked on nodes belonging to other threads.
+  inline bool isLiteral() const
+  {
+    return deps.empty();
+  }
+
+  // Literals created on other threads, such as a shared system matrix, may be read by any
+  // graph. Unevaluated nodes may only be used by graphs built on the thread that created them,
+  // since evaluating a graph rewrites its nodes and updates the variables that hold them.
+  inline bool mayDependOn(const ExpressionNode* const node) const
+  {
+    return node->creator == creator || node->isLiteral();
+  }
+
+  static std::size_t newVisitMark()
+  {
+    return ++nextVisitMark;
+  }
+
+  // Keeps every user ranked above this node after one of its dependencies changes. Literals are
+  // never raised, and only literals may have users on other threads, so every node reached
+  // belongs to this thread even when it is bound to a different context.
+  void raiseRank(const std::size_t minimum)
+  {
+    if (rank >= minimum)
+      return;
 
-      std::for_each(node->deps.begin(), node->deps.end(), boost::bind(getLeavesHelper, boost::ref(visited), boost::ref(leaves), _1));
-      std::for_each(node->internal_reqBy.begin(), node->internal_reqBy.end(), boost::bind(getLeavesHelper, boost::ref(visited), boost::ref(leaves), _1));
-    }	   
+    rank = minimum;
+    std::vector<ExpressionNode*> raised(1, this);
+
+    while(!raised.empty())
+    {
+      ExpressionNode* const node = raised.back();
+      raised.pop_back();
+      const NodeList reqBy(node->getInternalRequiredBy());
+
+      for(typename NodeList::const_iterator reqByIter = reqBy.begin(); reqByIter != reqBy.end(); ++reqByIter)
+      {
+        assert((*reqByIter)->creator == creator);
+
+        if ((*reqByIter)->rank <= node->rank)
+        {
+          (*reqByIter)->rank = node->rank + 1;
+          raised.push_back(*reqByIter);
+        }
+      }
+    }
   }
 
+  // Nodes created by other threads or bound to other contexts belong to independent expression
+  // graphs and are never evaluated together with ours, even if they share a dependency. Nodes are
+  // visited in the same preorder as a recursive walk of dependencies then users.
   std::vector<ExpressionNode*> getLeaves() 
   {
-    std::set<ExpressionNode*> visited;
+    const std::size_t mark = newVisitMark();
     std::vector<ExpressionNode*> leaves;
-    getLeavesHelper(visited, leaves, this);
+    std::vector<ExpressionNode*> stack(1, this);
+
+    while(!stack.empty())
+    {
+      ExpressionNode* const node = stack.back();
+      stack.pop_back();
+
+      if (!sharesGraphWith(node) || node->visitMark == mark)
+        continue;
+
+      node->visitMark = mark;
+      const NodeList reqBy(node->getInternalRequiredBy());
+      bool requiredBySameGraph = false;
+
+      for(typename NodeList::const_iterator reqByIter = reqBy.begin(); reqByIter != reqBy.end(); ++reqByIter)
+        requiredBySameGraph = requiredBySameGraph || sharesGraphWith(*reqByIter);
+
+      if (!requiredBySameGraph)
+        leaves.push_back(node);
+
+      stack.insert(stack.end(), reqBy.rbegin(), reqBy.rend());
+      stack.insert(stack.end(), node->deps.rbegin(), node->deps.rend());
+    }
+
     return leaves;
   }
 
-  template<typename OutputIterator>
-  static void getTopologicallySortedNodesHelper(ExpressionNode* const node, std::set<ExpressionNode*>& visited, OutputIterator& out)
+  // Stable, and linear in the number of nodes when their ranks are not too widely spread
+  static void sortByRank(std::vector<ExpressionNode*>& nodes)
   {
-    if (visited.insert(node).second)
+    if (nodes.empty())
+      return;
+
+    std::size_t minRank = nodes.front()->rank;
+    std::size_t maxRank = minRank;
+
+    for(typename std::vector<ExpressionNode*>::const_iterator nodeIter = nodes.begin(); nodeIter != nodes.end(); ++nodeIter)
+    {
+      minRank = std::min(minRank, (*nodeIter)->rank);
+      maxRank = std::max(maxRank, (*nodeIter)->rank);
+    }
+
+    if (maxRank - minRank > 4 * nodes.size())
     {
-      std::for_each(node->deps.begin(), node->deps.end(), boost::bind(getTopologicallySortedNodesHelper<OutputIterator>, _1, boost::ref(visited), out));
-      *out++ = node;
+      std::stable_sort(nodes.begin(), nodes.end(), rankLess);
+      return;
     }
+
+    std::vector<std::size_t> offsets(maxRank - minRank + 2, 0);
+
+    for(typename std::vector<ExpressionNode*>::const_iterator nodeIter = nodes.begin(); nodeIter != nodes.end(); ++nodeIter)
+      ++offsets[(*nodeIter)->rank - minRank + 1];
+
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<ExpressionNode*> sorted(nodes.size());
+
+    for(typename std::vector<ExpressionNode*>::const_iterator nodeIter = nodes.begin(); nodeIter != nodes.end(); ++nodeIter)
+      sorted[offsets[(*nodeIter)->rank - minRank]++] = *nodeIter;
+
+    nodes.swap(sorted);
+  }
+
+  static bool rankLess(const ExpressionNode* const a, const ExpressionNode* const b)
+  {
+    return a->rank < b->rank;
+  }
+
+  static double getTime()
+  {
+    timeval time;
+    gettimeofday(&time, NULL);
+    return time.tv_sec + time.tv_usec/1000000.0;
+  }
+
+  std::vector<ExpressionNode*> getEvaluationNodes()
+  {
+    const double startTime = getTime();
+    const std::vector<ExpressionNode*> nodes(getTopologicallySortedNodes(getLeaves()));
+    getContext().getStatisticsCollector().addSetupTime(getTime() - startTime);
+    return nodes;
   }
 
   std::auto_ptr< ExpressionGraph<T_element> > getExpressionGraph(const std::vector<ExpressionNode*>& nodes)
   {
-    const ConfigurationManager& configurationManager(ConfigurationManager::getConfigurationManager());
+    const ConfigurationManager& configurationManager(getContext().getConfigurationManager());
     const bool useProfiler = configurationManager.livenessAnalysisEnabled();
 
     std::auto_ptr< ExpressionGraph<T_element> >  expressionGraph(new ExpressionGraph<T_element>(nodes.begin(), nodes.end()));
     if (useProfiler)
     {
-      Profiler<T_element>& profiler = Profiler<T_element>::getProfiler();
+      Profiler<T_element>& profiler = getContext().template getCache< Profiler<T_element> >();
       return profiler.getAnnotatedExpressionGraph(*expressionGraph, *this);
     }
     else
@@ -138,12 +382,16 @@ protected:
     assert(&previous == this);
    
     // Inherit monitoring from node being replaced
-    next.monitors.insert(previous.monitors.begin(), previous.monitors.end());
+    std::for_each(previous.monitors.begin(), previous.monitors.end(), boost::bind(&ExpressionNode::addMonitor, &next, _1));
     previous.monitors.clear();
+
+    // Evaluated values remain bound to the context of the expression they replace
+    if (next.context == NULL)
+      next.context = previous.context;
     
     // We make copies because this node might be deleted during this method
-    const std::multiset<const Variable<T_element>*> localExternalReqBy(external_reqBy);
-    const std::vector<ExpressionNode<T_element>*> localInternalReqBy(internal_reqBy);
+    const VariableList localExternalReqBy(getExternalRequiredBy());
+    const NodeList localInternalReqBy(getInternalRequiredBy());
 
     std::for_each(localExternalReqBy.begin(), localExternalReqBy.end(), boost::bind(updateVariable<exprType>, _1, boost::ref(previous), boost::ref(next)));
     std::for_each(localInternalReqBy.begin(), localInternalReqBy.end(), boost::bind(updateExpressionNode<exprType>, _1, boost::ref(previous), boost::ref(next)));
@@ -152,9 +400,21 @@ protected:
   inline void registerDependency(ExpressionNode* const e)
   {
     assert(e != NULL);
+
+    // Unbound operands adopt the context of whatever they are combined with
+    if (context == NULL)
+      context = e->context;
+
+    //FIXME: Throw an exception when values from different contexts are combined
+    assert(e->context == NULL || e->context == context);
+
+    //FIXME: Throw an exception when an unevaluated value from another thread is used
+    assert(mayDependOn(e));
     
     deps.push_back(e);
     e->registerRequiredBy(this);  
+    addPending(*e);
+    raiseRank(e->rank + 1);
   }
  
   inline void replaceDependency(ExpressionNode* const previous, ExpressionNode* const next)
@@ -162,86 +422,269 @@ protected:
     assert(previous != NULL);
     assert(next != NULL);
     
-    const typename std::vector<ExpressionNode*>::iterator location = std::find(deps.begin(), deps.end(), previous);
+    const typename NodeList::iterator location = std::find(deps.begin(), deps.end(), previous);
     assert(location != deps.end());
     *location = next;
     next->registerRequiredBy(this);
+    addPending(*next);
+    raiseRank(next->rank + 1);
     previous->unregisterRequiredBy(this);
   }
   
   inline void registerRequiredBy(ExpressionNode* const e)
   {
     assert(e != NULL);
+    boost::mutex::scoped_lock lock(getTrackingLock(this));
     internal_reqBy.push_back(e);
   }
   
-  inline void unregisterRequiredBy(ExpressionNode* const e)
+  // Returns true if nothing requires this node any longer
+  inline bool removeRequiredBy(ExpressionNode* const e)
   {
     assert(e != NULL);
-    // We only want to erase one instance from the multiset
-    const typename std::vector<ExpressionNode*>::iterator location = std::find(internal_reqBy.begin(), internal_reqBy.end(), e);
+    boost::mutex::scoped_lock lock(getTrackingLock(this));
+    // We only want to erase one instance
+    const typename NodeList::iterator location = std::find(internal_reqBy.begin(), internal_reqBy.end(), e);
     assert(location != internal_reqBy.end());
     internal_reqBy.erase(location);
-    checkSelfDestruct();
+    return isUnused();
   }
 
-  virtual void internal_evaluate()
+  inline void unregisterRequiredBy(ExpressionNode* const e)
   {
-    const std::vector<ExpressionNode*> leaves(getLeaves());
-    const std::vector<ExpressionNode*> nodes(getTopologicallySortedNodes(leaves));
+    if (removeRequiredBy(e))
+      selfDestruct();
+  }
 
-    std::auto_ptr< ExpressionGraph<T_element> > expressionGraph = getExpressionGraph(nodes);
-    StatisticsCollector& statsCollector = StatisticsCollector::getStatisticsCollector();
-    statsCollector.addFlops(expressionGraph->getFlops());
+  // Nodes other than this one may be replaced and freed
+  void simplifyExpressions(std::vector<ExpressionNode*>& nodes)
+  {
+    if (getContext().getConfigurationManager().algebraicSimplificationEnabled())
+    {
+      AlgebraicSimplifier<T_element> simplifier(getContext().getConfigurationManager().scalarReassociationEnabled());
+      simplifier.simplify(nodes, *this);
+
+      if (simplifier.getRewriteCount() > 0)
+        getContext().getStatisticsCollector().addRewrites(simplifier.getRewriteCount());
+    }
+  }
 
-    boost::shared_ptr< EvaluationStrategy<T_element> > strategy = expressionGraph->createEvaluationStrategy();
+  void eliminateCommonSubexpressions(std::vector<ExpressionNode*>& nodes)
+  {
+    if (getContext().getConfigurationManager().commonSubexpressionEliminationEnabled())
+    {
+      CommonSubexpressionEliminator<T_element> eliminator;
+      eliminator.eliminate(nodes, *this);
+
+      if (eliminator.getEliminatedCount() > 0)
+        getContext().getStatisticsCollector().addEliminated(eliminator.getEliminatedCount(),
+          eliminator.getEliminatedMatrixVectorMultCount(), eliminator.getEliminatedDotCount());
+    }
+  }
+
+  boost::shared_ptr< EvaluationStrategy<T_element> > createEvaluationStrategy(ExpressionGraph<T_element>& expressionGraph)
+  {
+    StatisticsCollector& statsCollector = getContext().getStatisticsCollector();
+    statsCollector.addFlops(expressionGraph.getFlops());
+
+    boost::shared_ptr< EvaluationStrategy<T_element> > strategy = expressionGraph.createEvaluationStrategy(getContext());
     TGEvaluatorFactory<T_element> tgEvaluatorFactory;
     strategy->addEvaluator(tgEvaluatorFactory);
-    strategy->execute();
+    return strategy;
+  }
+
+  virtual void internal_evaluate()
+  {
+    std::vector<ExpressionNode*> nodes(getEvaluationNodes());
+    simplifyExpressions(nodes);
+    eliminateCommonSubexpressions(nodes);
+
+    std::auto_ptr< ExpressionGraph<T_element> > expressionGraph = getExpressionGraph(nodes);
+    const boost::shared_ptr< EvaluationStrategy<T_element> > strategy(createEvaluationStrategy(*expressionGraph));
+
+    if (getContext().getConfigurationManager().pipelinedEvaluationEnabled())
+      AsyncEvaluation<T_element>::start(getContext(), nodes, expressionGraph, strategy, true);
+    else
+      strategy->execute();
+  }
+
+  // Returns NULL if nothing needs to be evaluated
+  virtual boost::shared_ptr< AsyncEvaluation<T_element> > internal_evaluate_async()
+  {
+    std::vector<ExpressionNode*> nodes(getEvaluationNodes());
+    simplifyExpressions(nodes);
+    eliminateCommonSubexpressions(nodes);
+
+    std::auto_ptr< ExpressionGraph<T_element> > expressionGraph = getExpressionGraph(nodes);
+    const boost::shared_ptr< EvaluationStrategy<T_element> > strategy(createEvaluationStrategy(*expressionGraph));
+    const bool pipelined = getContext().getConfigurationManager().pipelinedEvaluationEnabled();
+    return AsyncEvaluation<T_element>::start(getContext(), nodes, expressionGraph, strategy, pipelined);
+  }
+
+  void addMonitor(const PExpressionNodeRef<T_element>& monitor)
+  {
+    if (std::find(monitors.begin(), monitors.end(), monitor) == monitors.end())
+      monitors.push_back(monitor);
+  }
+
+  void notifyMonitors()
+  {
+    for(typename std::vector< PExpressionNodeRef<T_element> >::iterator monitorIterator = monitors.begin(); monitorIterator!=monitors.end(); ++monitorIterator)
+      monitorIterator->getPExpressionNode().notifyLive();
+
+    monitors.clear();
   }
 
 public:
-  ExpressionNode() : evaluationDirective(EVALUATE)
+  // Many nodes are created and destroyed per evaluation, so they are allocated from a pool
+  static void* operator new(const std::size_t size)
+  {
+    return NodePool::allocate(size);
+  }
+
+  static void operator delete(void* const p, const std::size_t size)
+  {
+    NodePool::deallocate(p, size);
+  }
+
+  ExpressionNode() : evaluationDirective(EVALUATE), creator(boost::this_thread::get_id()), context(NULL),
+    pendingNodes(0), pendingDepth(0), pendingBytes(0), measuredNodes(0), measuredBytes(0), rank(0), visitMark(0)
+  {
+  }
+
+  Context& getContext() const
+  {
+    return context == NULL ? Context::getDefaultContext() : *context;
+  }
+
+  // Only nodes sharing the graph of the node being evaluated may be rewritten during its evaluation
+  inline bool sharesGraphWith(const ExpressionNode* const node) const
+  {
+    return node->creator == creator && node->context == context;
+  }
+
+  void bindContext(Context& c)
+  {
+    //FIXME: Throw an exception when rebinding to a different context
+    assert(context == NULL || context == &c);
+    context = &c;
+  }
+
+  // Nodes created while rewriting a graph join the context of the node that graph belongs to
+  void adoptContext(const ExpressionNode& node)
   {
+    if (node.context != NULL)
+      bindContext(*node.context);
   }
 
-  std::vector<ExpressionNode*> getInternalRequiredBy() const
+  // Returns a snapshot, for callers which may cause the list to change while they use it
+  NodeList getInternalRequiredBy() const
   {
+    boost::mutex::scoped_lock lock(getTrackingLock(this));
     return internal_reqBy;
   }
   
-  std::multiset<const Variable<T_element>*> getExternalRequiredBy() const
+  VariableList getExternalRequiredBy() const
   {
+    boost::mutex::scoped_lock lock(getTrackingLock(this));
     return external_reqBy;
   }
+
+  std::size_t getInternalRequiredByCount() const
+  {
+    boost::mutex::scoped_lock lock(getTrackingLock(this));
+    return internal_reqBy.size();
+  }
+
+  std::size_t getExternalRequiredByCount() const
+  {
+    boost::mutex::scoped_lock lock(getTrackingLock(this));
+    return external_reqBy.size();
+  }
+
+  // True if some node outside the given set depends on this one
+  bool isRequiredOutside(const std::set<ExpressionNode*>& nodes) const
+  {
+    boost::mutex::scoped_lock lock(getTrackingLock(this));
+
+    for(typename NodeList::const_iterator reqByIter = internal_reqBy.begin(); reqByIter != internal_reqBy.end(); ++reqByIter)
+    {
+      if (nodes.find(*reqByIter) == nodes.end())
+        return true;
+    }
+
+    return false;
+  }
   
-  std::vector<ExpressionNode*> getDependencies() const
+  // Dependencies only change when the evaluating thread replaces them, so no copy is needed
+  const NodeList& getDependencies() const
   {
     return deps;
   }
   
   void registerRequiredBy(const Variable<T_element>& e)
   {
-    external_reqBy.insert(&e);
+    boost::mutex::scoped_lock lock(getTrackingLock(this));
+    external_reqBy.push_back(&e);
   }
   
   void unregisterRequiredBy(const Variable<T_element>& v)
   {
-    // We only want to erase one instance from the multiset
-    const typename std::multiset<const Variable<T_element>*>::iterator location = external_reqBy.find(&v);
-    assert(location != external_reqBy.end());
-    external_reqBy.erase(location);
-    checkSelfDestruct();
+    bool unused;
+    {
+      boost::mutex::scoped_lock lock(getTrackingLock(this));
+      // We only want to erase one instance
+      const typename VariableList::iterator location = std::find(external_reqBy.begin(), external_reqBy.end(), &v);
+      assert(location != external_reqBy.end());
+      external_reqBy.erase(location);
+      unused = isUnused();
+    }
+
+    if (unused)
+      selfDestruct();
   }
 
+  // Gathers the given nodes and everything they depend on, ordered by rank. Nodes created on
+  // the evaluating thread are marked in place. Literals from other threads are tracked in a set
+  // and never marked, and the walk never continues into an unevaluated node from another thread.
   static std::vector<ExpressionNode*> getTopologicallySortedNodes(const std::vector<ExpressionNode*>& leaves)
   { 
     std::vector<ExpressionNode*> nodes;
-    std::set<ExpressionNode*> visited; 
-    typedef std::back_insert_iterator< std::vector<ExpressionNode*> > OutputIterator;
-    OutputIterator out(nodes);
-    std::for_each(leaves.begin(), leaves.end(), boost::bind(getTopologicallySortedNodesHelper<OutputIterator>,
-      _1, boost::ref(visited), boost::ref(out)));
+
+    if (leaves.empty())
+      return nodes;
+
+    const ExpressionNode* const owner = leaves.front();
+    const std::size_t mark = newVisitMark();
+    std::set<ExpressionNode*> visitedForeign;
+    std::vector<ExpressionNode*> stack(leaves.rbegin(), leaves.rend());
+
+    while(!stack.empty())
+    {
+      ExpressionNode* const node = stack.back();
+      stack.pop_back();
+
+      if (node->creator == owner->creator)
+      {
+        if (node->visitMark == mark)
+          continue;
+
+        node->visitMark = mark;
+        stack.insert(stack.end(), node->deps.rbegin(), node->deps.rend());
+      }
+      else
+      {
+        if (!node->isLiteral())
+          throw DesolaLogicError("Attempted to evaluate an expression using an unevaluated value from another thread");
+
+        if (!visitedForeign.insert(node).second)
+          continue;
+      }
+
+      nodes.push_back(node);
+    }
+
+    sortByRank(nodes);
     return nodes;
   }
 
@@ -252,11 +695,53 @@ public:
   
   void evaluate()
   {
-    for(typename std::set< PExpressionNodeRef<T_element> >::iterator monitorIterator = monitors.begin(); monitorIterator!=monitors.end(); ++monitorIterator)
-      monitorIterator->getPExpressionNode().notifyLive();
+    if (AsyncEvaluation<T_element>::completePending(*this))
+    {
+      notifyMonitors();
+      internal_evaluate();
+    }
+  }
 
-    monitors.clear();
-    internal_evaluate();
+  // Evaluates this node if the unevaluated graph it depends on exceeds the budget set in the
+  // configuration of its context. The depth estimate is exact unless dependencies have been
+  // replaced, so only the node and byte estimates are refined before deciding. Until they have
+  // doubled since the last measurement the graph is left to grow, so the node and byte budgets
+  // may be exceeded by up to a factor of two.
+  void evaluateIfOverBudget()
+  {
+    const ConfigurationManager& configurationManager(getContext().getConfigurationManager());
+
+    if (pendingNodes == 0 || !exceedsBudget(configurationManager))
+      return;
+
+    const std::size_t maxDepth = configurationManager.getMaxPendingDepth();
+
+    if (maxDepth == 0 || pendingDepth <= maxDepth)
+    {
+      if (!estimatesDoubledSinceMeasured())
+        return;
+
+      measurePending();
+
+      if (!exceedsBudget(configurationManager))
+        return;
+    }
+
+    evaluate();
+  }
+
+  // Starts evaluating the graph containing this node on a worker thread
+  boost::shared_ptr< AsyncEvaluation<T_element> > evaluateAsync()
+  {
+    if (AsyncEvaluation<T_element>::completePending(*this))
+    {
+      notifyMonitors();
+      return internal_evaluate_async();
+    }
+    else
+    {
+      return boost::shared_ptr< AsyncEvaluation<T_element> >();
+    }
   }
     
   virtual void accept(ExpressionNodeVisitor<T_element>& visitor) = 0;
@@ -267,6 +752,9 @@ public:
 
   virtual Maybe<double> getFlops() const = 0;
 
+  // The size of this node's value if it were stored densely
+  virtual std::size_t getValueBytes() const = 0;
+
   void setEvaluationDirective(const EvaluationDirective d)
   {
     evaluationDirective = d;
@@ -279,17 +767,23 @@ public:
 
   void notifyOfUse(PExpressionNodeRef<T_element>& monitor)
   {
-    monitors.insert(monitor);
+    addMonitor(monitor);
   }
 
   virtual ~ExpressionNode() 
   {
-    for(typename std::set< PExpressionNodeRef<T_element> >::iterator monitorIterator = monitors.begin(); monitorIterator!=monitors.end(); ++monitorIterator)
+    for(typename std::vector< PExpressionNodeRef<T_element> >::iterator monitorIterator = monitors.begin(); monitorIterator!=monitors.end(); ++monitorIterator)
       monitorIterator->getPExpressionNode().notifyDead();
   }
 
 };
 
+template<typename T_element>
+boost::mutex ExpressionNode<T_element>::trackingLocks[ExpressionNode<T_element>::trackingLockCount];
+
+template<typename T_element>
+boost::atomic<std::size_t> ExpressionNode<T_element>::nextVisitMark(0);
+
 }
 
 }
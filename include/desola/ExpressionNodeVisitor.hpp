@@ -44,6 +44,7 @@ public:
   virtual void visit(VectorDot<T_element>& e)= 0;	
   virtual void visit(VectorCross<T_element>& e)= 0;
   virtual void visit(VectorTwoNorm<T_element>& e)= 0;
+  virtual void visit(VectorAxpby<T_element>& e)= 0;
   virtual void visit(MatrixTranspose<T_element>& e)= 0;
 
   virtual void visit(ElementGet<vector, T_element>& e)= 0;
@@ -52,6 +53,9 @@ public:
   virtual void visit(ElementSet<vector, T_element>& e)= 0;
   virtual void visit(ElementSet<matrix, T_element>& e)= 0;
 
+  virtual void visit(Slice<vector, T_element>& e)= 0;
+  virtual void visit(Slice<matrix, T_element>& e)= 0;
+
   virtual void visit(Literal<scalar, T_element>& e)= 0;
   virtual void visit(Literal<vector, T_element>& e)= 0;
   virtual void visit(Literal<matrix, T_element>& e)= 0;
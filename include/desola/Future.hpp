@@ -0,0 +1,65 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef DESOLA_FUTURE_HPP
+#define DESOLA_FUTURE_HPP
+
+#include <boost/shared_ptr.hpp>
+#include <desola/Desola_fwd.hpp>
+
+namespace desola
+{
+
+// The value of a scalar being evaluated on a worker thread. The thread that created the future
+// may continue to build expressions while the evaluation runs. Any other evaluation started
+// on that thread first waits for it to complete. A future must be waited on by the thread that
+// created it.
+template<typename T_element>
+class Future
+{
+private:
+  friend class Scalar<T_element>;
+
+  Scalar<T_element> scalar;
+  boost::shared_ptr< detail::AsyncEvaluation<T_element> > evaluation;
+
+  Future(const Scalar<T_element>& s, const boost::shared_ptr< detail::AsyncEvaluation<T_element> >& e) : scalar(s), evaluation(e)
+  {
+  }
+
+public:
+  bool is_ready() const
+  {
+    return !evaluation || evaluation->isReady();
+  }
+
+  void wait() const
+  {
+    if (evaluation)
+      evaluation->complete();
+  }
+
+  const T_element get() const
+  {
+    wait();
+    return scalar.value();
+  }
+};
+
+}
+
+#endif
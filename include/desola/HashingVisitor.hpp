@@ -0,0 +1,305 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef DESOLA_HASHING_VISITOR_HPP
+#define DESOLA_HASHING_VISITOR_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+#include <typeinfo>
+#include <boost/functional/hash.hpp>
+#include <desola/Desola_fwd.hpp>
+
+namespace desola
+{
+
+namespace detail
+{
+
+// The type, operands and parameters of a single node, which is all that is
+// needed to compare two nodes of the same graph.
+struct ExpressionNodeKey
+{
+  static const std::size_t maxOperands = 4;
+  static const std::size_t maxAttributes = 6;
+
+  const std::type_info* type;
+  const void* operands[maxOperands];
+  std::size_t attributes[maxAttributes];
+
+  bool operator==(const ExpressionNodeKey& k) const
+  {
+    return *type == *k.type
+      && std::equal(operands, operands + maxOperands, k.operands)
+      && std::equal(attributes, attributes + maxAttributes, k.attributes);
+  }
+};
+
+// Counterpart of the profiling and TaskGraph hashing visitors for the nodes
+// of a graph that has not been evaluated yet. Unlike those, it never compares
+// nodes from different graphs, so operands are identified by address rather
+// than by a numbering. Literals and element assignments are not hashable.
+template<typename T_element>
+class HashingVisitor : public ExpressionNodeVisitor<T_element>
+{
+private:
+  ExpressionNodeKey key;
+  std::size_t operandCount;
+  std::size_t attributeCount;
+  std::size_t hash;
+  bool hashable;
+
+  template<typename T_node>
+  void hashExprNode(const T_node& node)
+  {
+    const char* const nodeTypeString = typeid(node).name();
+    key.type = &typeid(node);
+    hash = boost::hash_range(nodeTypeString, nodeTypeString+strlen(nodeTypeString));
+    hashable = true;
+  }
+
+  void hashOperand(const ExpressionNode<T_element>& operand)
+  {
+    assert(operandCount < ExpressionNodeKey::maxOperands);
+    key.operands[operandCount++] = &operand;
+    boost::hash_combine(hash, &operand);
+  }
+
+  void hashAttribute(const std::size_t attribute)
+  {
+    assert(attributeCount < ExpressionNodeKey::maxAttributes);
+    key.attributes[attributeCount++] = attribute;
+    boost::hash_combine(hash, attribute);
+  }
+
+  template<typename resultType, typename exprType>
+  void hashUnOp(const UnOp<resultType, exprType, T_element>& unop)
+  {
+    hashExprNode(unop);
+    hashOperand(unop.getOperand());
+  }
+
+  template<typename resultType, typename leftType, typename rightType>
+  void hashBinOp(const BinOp<resultType, leftType, rightType, T_element>& binop)
+  {
+    hashExprNode(binop);
+    hashOperand(binop.getLeft());
+    hashOperand(binop.getRight());
+  }
+
+  template<typename exprType>
+  void hashPairwise(const Pairwise<exprType, T_element>& node)
+  {
+    hashBinOp(node);
+    hashAttribute(node.getOperation());
+  }
+
+  template<typename exprType>
+  void hashScalarPiecewise(const ScalarPiecewise<exprType, T_element>& node)
+  {
+    hashBinOp(node);
+    hashAttribute(node.getOperation());
+  }
+
+  void hashVectorAxpby(const VectorAxpby<T_element>& node)
+  {
+    hashExprNode(node);
+    hashOperand(node.getX());
+    hashOperand(node.getAlpha());
+    hashOperand(node.getY());
+    hashOperand(node.getBeta());
+    hashAttribute(node.getOperation());
+  }
+
+public:
+  HashingVisitor() : operandCount(0), attributeCount(0), hash(0), hashable(false)
+  {
+    key.type = NULL;
+    std::fill(key.operands, key.operands + ExpressionNodeKey::maxOperands, static_cast<const void*>(NULL));
+    std::fill(key.attributes, key.attributes + ExpressionNodeKey::maxAttributes, 0);
+  }
+
+  bool isHashable() const
+  {
+    return hashable;
+  }
+
+  inline std::size_t getHash() const
+  {
+    return hash;
+  }
+
+  const ExpressionNodeKey& getKey() const
+  {
+    return key;
+  }
+
+  virtual void visit(Pairwise<scalar, T_element>& e)
+  {
+    hashPairwise(e);
+  }
+
+  virtual void visit(Pairwise<vector, T_element>& e)
+  {
+    hashPairwise(e);
+  }
+
+  virtual void visit(Pairwise<matrix, T_element>& e)
+  {
+    hashPairwise(e);
+  }
+
+  virtual void visit(ScalarPiecewise<scalar, T_element>& e)
+  {
+    hashScalarPiecewise(e);
+  }
+
+  virtual void visit(ScalarPiecewise<vector, T_element>& e)
+  {
+    hashScalarPiecewise(e);
+  }
+
+  virtual void visit(ScalarPiecewise<matrix, T_element>& e)
+  {
+    hashScalarPiecewise(e);
+  }
+
+  virtual void visit(MatrixMult<T_element>& e)
+  {
+    hashBinOp(e);
+  }
+
+  virtual void visit(MatrixVectorMult<T_element>& e)
+  {
+    hashBinOp(e);
+  }
+
+  virtual void visit(TransposeMatrixVectorMult<T_element>& e)
+  {
+    hashBinOp(e);
+  }
+
+  virtual void visit(VectorDot<T_element>& e)
+  {
+    hashBinOp(e);
+  }
+
+  virtual void visit(VectorCross<T_element>& e)
+  {
+    hashBinOp(e);
+  }
+
+  virtual void visit(VectorTwoNorm<T_element>& e)
+  {
+    hashUnOp(e);
+  }
+
+  virtual void visit(MatrixTranspose<T_element>& e)
+  {
+    hashUnOp(e);
+  }
+
+  virtual void visit(VectorAxpby<T_element>& e)
+  {
+    hashVectorAxpby(e);
+  }
+
+  virtual void visit(ElementGet<vector, T_element>& e)
+  {
+    hashUnOp(e);
+    hashAttribute(e.getIndex().getRow());
+  }
+
+  virtual void visit(ElementGet<matrix, T_element>& e)
+  {
+    hashUnOp(e);
+    hashAttribute(e.getIndex().getRow());
+    hashAttribute(e.getIndex().getCol());
+  }
+
+  virtual void visit(ElementSet<vector, T_element>& e)
+  {
+  }
+
+  virtual void visit(ElementSet<matrix, T_element>& e)
+  {
+  }
+
+  virtual void visit(Slice<vector, T_element>& e)
+  {
+    hashUnOp(e);
+    hashAttribute(e.getRowCount());
+    hashAttribute(e.getOffset().getRow());
+    hashAttribute(e.getStride().getRow());
+  }
+
+  virtual void visit(Slice<matrix, T_element>& e)
+  {
+    hashUnOp(e);
+    hashAttribute(e.getRowCount());
+    hashAttribute(e.getColCount());
+    hashAttribute(e.getOffset().getRow());
+    hashAttribute(e.getOffset().getCol());
+    hashAttribute(e.getStride().getRow());
+    hashAttribute(e.getStride().getCol());
+  }
+
+  virtual void visit(Literal<scalar, T_element>& e)
+  {
+  }
+
+  virtual void visit(Literal<vector, T_element>& e)
+  {
+  }
+
+  virtual void visit(Literal<matrix, T_element>& e)
+  {
+  }
+
+  virtual void visit(Negate<scalar, T_element>& e)
+  {
+    hashUnOp(e);
+  }
+
+  virtual void visit(Negate<vector, T_element>& e)
+  {
+    hashUnOp(e);
+  }
+
+  virtual void visit(Negate<matrix, T_element>& e)
+  {
+    hashUnOp(e);
+  }
+
+  virtual void visit(Absolute<T_element>& e)
+  {
+    hashUnOp(e);
+  }
+
+  virtual void visit(SquareRoot<T_element>& e)
+  {
+    hashUnOp(e);
+  }
+};
+
+}
+
+}
+
+#endif
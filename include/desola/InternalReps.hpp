@@ -22,8 +22,16 @@
 #include <vector>
 #include <cstddef>
 #include <algorithm>
+#include <iterator>
 #include <desola/Desola_fwd.hpp>
-#include <boost/scoped_array.hpp>
+#include <desola/ExecutionQueue.hpp>
+#include <desola/StoragePool.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/type_traits/is_pod.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/atomic.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <boost/tuple/tuple_comparison.hpp>
 #include <desola/file-access/mtl_entry.hpp>
@@ -40,10 +48,31 @@ class InternalValue
 protected:
   bool allocated;
 
+  // Set when the value is computed by an evaluation queued on an execution thread
+  boost::shared_ptr<ExecutionTicket> producer;
+
 public:
   InternalValue(const bool isAllocated) : allocated(isAllocated) 
   {
   }
+
+  void setProducer(const boost::shared_ptr<ExecutionTicket>& ticket)
+  {
+    producer = ticket;
+  }
+
+  // Rethrows any exception raised while computing the value
+  void waitUntilReady() const
+  {
+    if (producer)
+    {
+      producer->wait();
+      const boost::exception_ptr error(producer->getError());
+
+      if (error)
+        boost::rethrow_exception(error);
+    }
+  }
   
   inline bool isAllocated() const
   {
@@ -52,6 +81,12 @@ public:
   
   virtual void allocate() = 0;
 
+  // True if every element is known to equal one value without evaluating anything
+  virtual bool isUniform(T_element& element) const
+  {
+    return false;
+  }
+
   virtual ~InternalValue() {}
 };
 
@@ -113,23 +148,204 @@ public:
 
   virtual std::size_t nnz() const = 0;
 
+  virtual bool isIdentity() const
+  {
+    return false;
+  }
+
   virtual void accept(InternalMatrixVisitor<T_element>& visitor) = 0;
 
   virtual T_element getElementValue(const ElementIndex<matrix>& index) = 0;
 };
 
+// Plain data arrays come from the storage pool. Types with constructors are allocated with new[].
+template<typename T, bool pooled = boost::is_pod<T>::value>
+struct StorageAllocator
+{
+  static T* allocate(const std::size_t count)
+  {
+    return static_cast<T*>(StoragePool::allocate(count * sizeof(T)));
+  }
+
+  static void deallocate(T* const data, const std::size_t count)
+  {
+    StoragePool::deallocate(data, count * sizeof(T));
+  }
+};
+
+template<typename T>
+struct StorageAllocator<T, false>
+{
+  static T* allocate(const std::size_t count)
+  {
+    return new T[count];
+  }
+
+  static void deallocate(T* const data, const std::size_t count)
+  {
+    delete[] data;
+  }
+};
+
+// An array which is either allocated by the library, adopted from the caller and freed
+// with delete[], or borrowed from the caller
+template<typename T>
+class StorageArray : boost::noncopyable
+{
+private:
+  enum Origin
+  {
+    POOLED,
+    ADOPTED,
+    BORROWED
+  };
+
+  T* data;
+  std::size_t count;
+  Origin origin;
+
+  void release()
+  {
+    if (origin == POOLED)
+      StorageAllocator<T>::deallocate(data, count);
+    else if (origin == ADOPTED)
+      delete[] data;
+  }
+
+public:
+  StorageArray() : data(NULL), count(0), origin(POOLED)
+  {
+  }
+
+  StorageArray(T* const d, const StorageOwnership ownership) : data(d), count(0), origin(ownership == ADOPT_STORAGE ? ADOPTED : BORROWED)
+  {
+  }
+
+  // The elements are left uninitialised
+  void allocate(const std::size_t c)
+  {
+    T* const allocated = StorageAllocator<T>::allocate(c);
+    release();
+    data = allocated;
+    count = c;
+    origin = POOLED;
+  }
+
+  inline T* get() const
+  {
+    return data;
+  }
+
+  inline T& operator[](const std::size_t index) const
+  {
+    return data[index];
+  }
+
+  inline bool isBorrowed() const
+  {
+    return origin == BORROWED;
+  }
+
+  // Transfers ownership of the array, leaving this one borrowing it
+  void donate(StorageArray& recipient)
+  {
+    assert(origin != BORROWED);
+    recipient.release();
+    recipient.data = data;
+    recipient.count = count;
+    recipient.origin = origin;
+    origin = BORROWED;
+  }
+
+  ~StorageArray()
+  {
+    release();
+  }
+};
+
+// Dense storage whose elements are given by a fill value and a diagonal value until a pointer
+// to it is first requested. Constant vectors and zero or identity matrices therefore take no
+// memory unless generated code reads them or they are written to.
+template<typename T_element>
+class DeferredFill : boost::noncopyable
+{
+private:
+  const T_element fill;
+  const T_element diagonal;
+  boost::atomic<bool> pending;
+  boost::mutex mutex;
+
+public:
+  DeferredFill() : fill(), diagonal(), pending(false)
+  {
+  }
+
+  DeferredFill(const T_element f, const T_element d) : fill(f), diagonal(d), pending(true)
+  {
+  }
+
+  inline bool isPending() const
+  {
+    return pending;
+  }
+
+  T_element getElement(const std::size_t row, const std::size_t col) const
+  {
+    return row == col ? diagonal : fill;
+  }
+
+  bool isUniform(const std::size_t rows, const std::size_t cols, T_element& element) const
+  {
+    if (!pending || (fill != diagonal && std::min(rows, cols) > 0))
+      return false;
+
+    element = fill;
+    return true;
+  }
+
+  bool isIdentity(const std::size_t rows, const std::size_t cols) const
+  {
+    return pending && rows == cols && fill == T_element(0) && diagonal == T_element(1);
+  }
+
+  // Elements are stored in row-major order
+  void materialise(StorageArray<T_element>& storage, const std::size_t rows, const std::size_t cols)
+  {
+    if (!pending)
+      return;
+
+    boost::mutex::scoped_lock lock(mutex);
+
+    if (pending)
+    {
+      storage.allocate(rows * cols);
+      std::fill(storage.get(), storage.get() + rows * cols, fill);
+
+      if (diagonal != fill)
+      {
+        for(std::size_t index = 0; index < std::min(rows, cols); ++index)
+          storage[index * cols + index] = diagonal;
+      }
+
+      pending = false;
+    }
+  }
+};
+
 template<typename T_element>
 class ConventionalScalar : public InternalScalar<T_element>
 {
 private:
   T_element value;
+  const bool constant;
   
 public:
-  ConventionalScalar() : InternalScalar<T_element>(true), value(T_element(0))
+  // Holds a value computed by an evaluation
+  ConventionalScalar() : InternalScalar<T_element>(true), value(T_element(0)), constant(false)
   {
   }
 
-  ConventionalScalar(const T_element initialValue) : InternalScalar<T_element>(true), value(initialValue)
+  ConventionalScalar(const T_element initialValue) : InternalScalar<T_element>(true), value(initialValue), constant(true)
   {
   }  
 
@@ -149,6 +365,18 @@ public:
     return value;
   } 
 
+  // Computed values, such as the step lengths of an iterative solver, usually
+  // differ between evaluations of the same graph, so folding them would only
+  // defeat code caching. They are never treated as constants.
+  virtual bool isUniform(T_element& element) const
+  {
+    if (!constant)
+      return false;
+
+    element = value;
+    return true;
+  }
+
   T_element* getValue()
   {
     assert(this->allocated);
@@ -160,23 +388,54 @@ template<typename T_element>
 class ConventionalVector : public InternalVector<T_element>
 {
 private:
-  boost::scoped_array<T_element> value;
+  StorageArray<T_element> value;
+  DeferredFill<T_element> deferred;
   
 public:
-  ConventionalVector(const std::size_t rowCount) : InternalVector<T_element>(false, rowCount), value(NULL)
+  ConventionalVector(const std::size_t rowCount) : InternalVector<T_element>(false, rowCount)
+  {
+  }
+
+  ConventionalVector(const std::size_t rowCount, const T_element initialValue) : InternalVector<T_element>(true, rowCount), 
+    deferred(initialValue, initialValue)
+  {
+  }
+
+  template<typename InputIterator>
+  ConventionalVector(InputIterator begin, InputIterator end) : InternalVector<T_element>(true, std::distance(begin, end))
+  {
+    value.allocate(this->rows);
+    std::copy(begin, end, value.get());
+  }
+
+  ConventionalVector(const std::size_t rowCount, T_element* const data, const StorageOwnership ownership) : InternalVector<T_element>(true, rowCount), value(data, ownership)
+  {
+    assert(data != NULL);
+  }
+
+  // Borrowed storage must not be modified
+  bool isBorrowed() const
   {
+    return value.isBorrowed();
   }
 
-  ConventionalVector(const std::size_t rowCount, const T_element initialValue) : InternalVector<T_element>(true, rowCount), value(new T_element[rowCount])
+  // Hands the array to an unallocated vector of the same size, so a result can be
+  // computed in place of this value. This vector must not be written afterwards.
+  bool donateStorage(ConventionalVector& recipient)
   {
-    std::fill(value.get(), value.get() + this->rows, initialValue);
+    if (!this->allocated || isBorrowed() || deferred.isPending() || recipient.allocated || recipient.rows != this->rows)
+      return false;
+
+    value.donate(recipient.value);
+    recipient.allocated = true;
+    return true;
   }
 
   virtual void allocate()
   {
     if(!this->allocated)
     {
-      value.reset(new T_element[this->rows]);
+      value.allocate(this->rows);
       this->allocated=true;
     }
   }
@@ -186,16 +445,22 @@ public:
     visitor.visit(*this);
   }
 
+  virtual bool isUniform(T_element& element) const
+  {
+    return deferred.isUniform(this->rows, 1, element);
+  }
+
   T_element* getValue()
   {
     assert(this->allocated);
+    deferred.materialise(value, this->rows, 1);
     return value.get();
   }
 
   virtual T_element getElementValue(const ElementIndex<vector>& index)
   {
     assert(this->allocated);
-    return value[index.getRow()];
+    return deferred.isPending() ? deferred.getElement(index.getRow(), 0) : value[index.getRow()];
   }
 };
 
@@ -203,16 +468,46 @@ template<typename T_element>
 class ConventionalMatrix : public InternalMatrix<T_element>
 {
 private:
-  boost::scoped_array<T_element> value;
+  StorageArray<T_element> value;
+  DeferredFill<T_element> deferred;
   
 public:
-  ConventionalMatrix(const std::size_t rowCount, const std::size_t colCount) : InternalMatrix<T_element>(false, rowCount, colCount), value(NULL)
+  ConventionalMatrix(const std::size_t rowCount, const std::size_t colCount) : InternalMatrix<T_element>(false, rowCount, colCount)
   {
   }
 
+  // Every element is the fill value except those on the leading diagonal
+  ConventionalMatrix(const std::size_t rowCount, const std::size_t colCount, const T_element fill, const T_element diagonal) : 
+    InternalMatrix<T_element>(true, rowCount, colCount), deferred(fill, diagonal)
+  {
+  }
+
+  // Elements are stored in row-major order
+  ConventionalMatrix(const std::size_t rowCount, const std::size_t colCount, T_element* const data, const StorageOwnership ownership) : 
+    InternalMatrix<T_element>(true, rowCount, colCount), value(data, ownership)
+  {
+    assert(data != NULL);
+  }
+
+  bool isBorrowed() const
+  {
+    return value.isBorrowed();
+  }
+
+  bool donateStorage(ConventionalMatrix& recipient)
+  {
+    if (!this->allocated || isBorrowed() || deferred.isPending() || recipient.allocated || recipient.rows != this->rows || recipient.cols != this->cols)
+      return false;
+
+    value.donate(recipient.value);
+    recipient.allocated = true;
+    return true;
+  }
+
   template<typename StreamType>
-  explicit ConventionalMatrix(StreamType& stream) : InternalMatrix<T_element>(true, stream.nrows(), stream.ncols()), value(new T_element[this->rows*this->cols])
+  explicit ConventionalMatrix(StreamType& stream) : InternalMatrix<T_element>(true, stream.nrows(), stream.ncols())
   {
+    value.allocate(this->rows * this->cols);
     while(!stream.eof())
     {
         entry2<double> entry;
@@ -225,7 +520,7 @@ public:
   {
     if(!this->allocated)
     {
-      value.reset(new T_element(this->rows * this->cols));
+      value.allocate(this->rows * this->cols);
       this->allocated=true;
     }
   }
@@ -240,16 +535,27 @@ public:
     return this->rows * this->cols;
   }
 
+  virtual bool isUniform(T_element& element) const
+  {
+    return deferred.isUniform(this->rows, this->cols, element);
+  }
+
+  virtual bool isIdentity() const
+  {
+    return deferred.isIdentity(this->rows, this->cols);
+  }
+
   T_element* getValue()
   {
     assert(this->allocated);
+    deferred.materialise(value, this->rows, this->cols);
     return value.get();
   }
 
   virtual T_element getElementValue(const ElementIndex<matrix>& index) 
   {
     assert(this->allocated);
-    return value[(this->cols*index.getRow())+index.getCol()];
+    return deferred.isPending() ? deferred.getElement(index.getRow(), index.getCol()) : value[(this->cols*index.getRow())+index.getCol()];
   }
 };
 
@@ -257,18 +563,24 @@ template<typename T_element>
 class CRSMatrix : public InternalMatrix<T_element>
 {
 private:
-  std::vector<int> col_ind;
-  std::vector<int> row_ptr;
-  std::vector<T_element> val;
+  std::size_t nonZeros;
+  StorageArray<int> col_ind;
+  StorageArray<int> row_ptr;
+  StorageArray<T_element> val;
   
 public:
-  CRSMatrix(const std::size_t rowCount, const std::size_t colCount) : InternalMatrix<T_element>(false, rowCount, colCount)
+  CRSMatrix(const std::size_t rowCount, const std::size_t colCount) : InternalMatrix<T_element>(false, rowCount, colCount), nonZeros(0)
   {
   }
 
   template<typename StreamType>
-  explicit CRSMatrix(StreamType& stream) : InternalMatrix<T_element>(true, stream.nrows(), stream.ncols())
+  explicit CRSMatrix(StreamType& stream) : InternalMatrix<T_element>(true, stream.nrows(), stream.ncols()), 
+    nonZeros(stream.nnz())
   {
+    col_ind.allocate(nonZeros);
+    row_ptr.allocate(this->getRowCount() + 1);
+    val.allocate(nonZeros);
+
     std::vector< boost::tuple<std::size_t, std::size_t, T_element> > matrixData;
     matrixData.reserve(stream.nnz());
 
@@ -282,39 +594,40 @@ public:
     }
 
     std::sort(matrixData.begin(), matrixData.end());
-
-    row_ptr.reserve(this->getRowCount() + 1);
-    col_ind.reserve(stream.nnz());
-    val.reserve(stream.nnz());
+    assert(matrixData.size() == nonZeros);
 
     std::size_t currentRow = 0;
-    row_ptr.push_back(0);
+    row_ptr[0] = 0;
 
     for(std::size_t index=0; index<matrixData.size(); ++index)
     {
       const boost::tuple<std::size_t, std::size_t, T_element>& entry(matrixData[index]);
 
       while(currentRow < boost::get<0>(entry))
-      {
-        row_ptr.push_back(val.size());
-        ++currentRow;
-      }
+        row_ptr[++currentRow] = index;
       
-      col_ind.push_back(boost::get<1>(entry));
-      val.push_back(boost::get<2>(entry));
+      col_ind[index] = boost::get<1>(entry);
+      val[index] = boost::get<2>(entry);
     }
-    row_ptr.push_back(val.size());
 
-    assert(row_ptr.size() == this->getRowCount() + 1);
-    assert(static_cast<int>(col_ind.size()) == stream.nnz());
-    assert(static_cast<int>(val.size()) == stream.nnz());
+    while(currentRow < this->getRowCount())
+      row_ptr[++currentRow] = nonZeros;
+  }
+
+  // Wraps existing CRS arrays. The row pointer array has one more entry than there are rows.
+  CRSMatrix(const std::size_t rowCount, const std::size_t colCount, int* const rowPtr, int* const colInd, T_element* const values, 
+            const StorageOwnership ownership) : InternalMatrix<T_element>(true, rowCount, colCount), 
+    nonZeros(rowPtr[rowCount]), col_ind(colInd, ownership), row_ptr(rowPtr, ownership), val(values, ownership)
+  {
+    assert(rowPtr[0] == 0);
   }
 
   virtual void allocate()
   {
     if(!this->allocated)
     {
-      row_ptr.resize(this->getRowCount()+1, 0);
+      row_ptr.allocate(this->getRowCount()+1);
+      std::fill(row_ptr.get(), row_ptr.get() + this->getRowCount()+1, 0);
       this->allocated=true;
     }
   }
@@ -326,42 +639,42 @@ public:
 
   std::size_t nnz() const
   {
-    return col_ind.size();
+    return nonZeros;
   }
 
   std::size_t row_ptr_size() const
   {
-    return row_ptr.size();
+    return row_ptr.get() == NULL ? 0 : this->getRowCount() + 1;
   }
 
   int* get_col_ind()
   {
-    return &col_ind[0];
+    return col_ind.get();
   }
 
   int* get_row_ptr()
   {
-    return &row_ptr[0];
+    return row_ptr.get();
   }
 
   T_element* get_val()
   {
-    return &val[0];
+    return val.get();
   }
 
   const int* get_col_ind() const
   {
-    return &col_ind[0];
+    return col_ind.get();
   }
 
   const int* get_row_ptr() const
   {
-    return &row_ptr[0];
+    return row_ptr.get();
   }
 
   const T_element* get_val() const
   {
-    return &val[0];
+    return val.get();
   }
 
   virtual T_element getElementValue(const ElementIndex<matrix>& index) 
@@ -21,6 +21,7 @@
 #include <cassert>
 #include <cstddef>
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/static_assert.hpp>
 #include <desola/Desola_fwd.hpp>
 
@@ -73,8 +74,14 @@ public:
     // We don't do anything for literals
   }
 
+  virtual boost::shared_ptr< AsyncEvaluation<T_element> > internal_evaluate_async()
+  {
+    return boost::shared_ptr< AsyncEvaluation<T_element> >();
+  }
+
   virtual T_element getElementValue()
   {
+    value->waitUntilReady();
     return value->getElementValue();
   }
 
@@ -126,8 +133,14 @@ public:
     // We don't do anything for literals
   }
 
+  virtual boost::shared_ptr< AsyncEvaluation<T_element> > internal_evaluate_async()
+  {
+    return boost::shared_ptr< AsyncEvaluation<T_element> >();
+  }
+
   virtual T_element getElementValue(const ElementIndex<vector>& index)
   {
+    value->waitUntilReady();
     return value->getElementValue(index);
   }
 
@@ -179,8 +192,14 @@ public:
     // We don't do anything for literals
   }
 
+  virtual boost::shared_ptr< AsyncEvaluation<T_element> > internal_evaluate_async()
+  {
+    return boost::shared_ptr< AsyncEvaluation<T_element> >();
+  }
+
   virtual T_element getElementValue(const ElementIndex<matrix>& index)
   {
+    value->waitUntilReady();
     return value->getElementValue(index);
   }
 
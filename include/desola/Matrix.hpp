@@ -19,6 +19,10 @@
 #define DESOLA_MATRIX_HPP
 
 #include <cstddef>
+#include <cassert>
+#include <vector>
+#include <map>
+#include <boost/array.hpp>
 #include <desola/Desola_fwd.hpp>
 
 namespace desola
@@ -30,6 +34,7 @@ class Matrix : public detail::Var<detail::matrix, T_element>
 public:
   friend class Scalar<T_element>;
   friend class Vector<T_element>;
+  friend class detail::BatchLayout<T_element>;
 
   // Typedefs for ITL
   typedef Scalar<T_element> value_type;
@@ -37,24 +42,79 @@ public:
 
   typedef detail::matrix expressionType;
 
+  // Matrices loaded without a context are unbound
   static Matrix loadDense(harwell_boeing_stream<T_element>& stream)
   {
-    return Matrix(*new detail::Literal<detail::matrix, T_element>(new detail::ConventionalMatrix<T_element>(stream)));
+    return createDense(stream);
   }
 
   static Matrix loadSparse(harwell_boeing_stream<T_element>& stream)
   {
-    return Matrix(*new detail::Literal<detail::matrix, T_element>(new detail::CRSMatrix<T_element>(stream)));
+    return createSparse(stream);
   }
 
   static Matrix loadDense(matrix_market_stream<T_element>& stream)
   {
-    return Matrix(*new detail::Literal<detail::matrix, T_element>(new detail::ConventionalMatrix<T_element>(stream)));
+    return createDense(stream);
   }
 
   static Matrix loadSparse(matrix_market_stream<T_element>& stream)
   {
-    return Matrix(*new detail::Literal<detail::matrix, T_element>(new detail::CRSMatrix<T_element>(stream)));
+    return createSparse(stream);
+  }
+
+  static Matrix loadDense(harwell_boeing_stream<T_element>& stream, Context& context)
+  {
+    const Matrix result(createDense(stream));
+    result.bindContext(context);
+    return result;
+  }
+
+  static Matrix loadSparse(harwell_boeing_stream<T_element>& stream, Context& context)
+  {
+    const Matrix result(createSparse(stream));
+    result.bindContext(context);
+    return result;
+  }
+
+  static Matrix loadDense(matrix_market_stream<T_element>& stream, Context& context)
+  {
+    const Matrix result(createDense(stream));
+    result.bindContext(context);
+    return result;
+  }
+
+  static Matrix loadSparse(matrix_market_stream<T_element>& stream, Context& context)
+  {
+    const Matrix result(createSparse(stream));
+    result.bindContext(context);
+    return result;
+  }
+
+  // Uses the caller's CRS arrays without copying them. rowPtr has rows + 1 entries.
+  static Matrix wrapSparse(const size_type rows, const size_type cols, int* const rowPtr, int* const colInd, T_element* const values, const StorageOwnership ownership)
+  {
+    return createSparse(rows, cols, rowPtr, colInd, values, ownership);
+  }
+
+  static Matrix wrapSparse(const size_type rows, const size_type cols, int* const rowPtr, int* const colInd, T_element* const values, const StorageOwnership ownership, Context& context)
+  {
+    const Matrix result(createSparse(rows, cols, rowPtr, colInd, values, ownership));
+    result.bindContext(context);
+    return result;
+  }
+
+  // The identity is only stored once it is written to or read by generated code
+  static Matrix identity(const size_type size)
+  {
+    return Matrix(*new detail::Literal<detail::matrix, T_element>(new detail::ConventionalMatrix<T_element>(size, size, T_element(0), T_element(1))));
+  }
+
+  static Matrix identity(const size_type size, Context& context)
+  {
+    const Matrix result(identity(size));
+    result.bindContext(context);
+    return result;
   }
 
   Matrix()
@@ -65,6 +125,30 @@ public:
   {
   }
 
+  Matrix(const size_type rows, const size_type cols, Context& context) : detail::Var<detail::matrix, T_element>(*new detail::Literal<detail::matrix, T_element>(new detail::ConventionalMatrix<T_element>(rows, cols)))
+  {
+    this->bindContext(context);
+  }
+
+  Matrix(const size_type rows, const size_type cols, const T_element initialValue) : detail::Var<detail::matrix, T_element>(*new detail::Literal<detail::matrix, T_element>(new detail::ConventionalMatrix<T_element>(rows, cols, initialValue, initialValue)))
+  {
+  }
+
+  Matrix(const size_type rows, const size_type cols, const T_element initialValue, Context& context) : detail::Var<detail::matrix, T_element>(*new detail::Literal<detail::matrix, T_element>(new detail::ConventionalMatrix<T_element>(rows, cols, initialValue, initialValue)))
+  {
+    this->bindContext(context);
+  }
+
+  // Uses the caller's row-major storage of rows * cols elements without copying it
+  Matrix(const size_type rows, const size_type cols, T_element* const data, const StorageOwnership ownership) : detail::Var<detail::matrix, T_element>(*new detail::Literal<detail::matrix, T_element>(new detail::ConventionalMatrix<T_element>(rows, cols, data, ownership)))
+  {
+  }
+
+  Matrix(const size_type rows, const size_type cols, T_element* const data, const StorageOwnership ownership, Context& context) : detail::Var<detail::matrix, T_element>(*new detail::Literal<detail::matrix, T_element>(new detail::ConventionalMatrix<T_element>(rows, cols, data, ownership)))
+  {
+    this->bindContext(context);
+  }
+
   Matrix(const Matrix& m) : detail::Var<detail::matrix, T_element>(m.getExpr())
   {
   }
@@ -88,7 +172,7 @@ public:
   Matrix& operator=(const Matrix& right)
   {
     if(this != &right)
-      this->setExpr(right.getExpr());
+      this->assignExpr(right.getExpr());
 
     return *this;
   }
@@ -96,7 +180,7 @@ public:
   const Matrix& operator=(const Scalar<T_element>& right)
   {
     using namespace detail;
-    this->setExpr(*new ScalarPiecewise<matrix, T_element>(piecewise_assign, this->getExpr(), right.getExpr()));
+    this->assignExpr(*new ScalarPiecewise<matrix, T_element>(piecewise_assign, this->getExpr(), right.getExpr()));
     return *this;
   }
 
@@ -167,6 +251,21 @@ public:
     return Matrix(*new Pairwise<matrix, T_element>(pair_div, this->getExpr(), right.getExpr()));
   }
 
+  // Refers to a block of rows by cols elements starting at (row, col), taking every
+  // rowStride-th row and colStride-th column, without copying them
+  const Matrix slice(const size_type row, const size_type col, const size_type rows, const size_type cols,
+                     const size_type rowStride = 1, const size_type colStride = 1) const
+  {
+    using namespace detail;
+    // FIXME: Handle these errors better
+    assert(rowStride > 0 && colStride > 0);
+    assert(rows == 0 || row + (rows-1) * rowStride < numRows());
+    assert(cols == 0 || col + (cols-1) * colStride < numCols());
+
+    const boost::array<std::size_t, 2> dims = { {rows, cols} };
+    return Matrix(*new Slice<matrix, T_element>(this->getExpr(), dims, ElementIndex<matrix>(row, col), ElementIndex<matrix>(rowStride, colStride)));
+  }
+
   ScalarElement<detail::matrix, T_element> operator()(const size_type row, const size_type col) const
   {
     using namespace detail;
@@ -174,7 +273,47 @@ public:
     return ScalarElement<matrix, T_element>(*this, index);
   }
 
+  // Evaluates once and copies every element in row-major order
+  void copyTo(T_element* const output) const
+  {
+    this->getExpr().evaluate();
+    detail::ElementReader<detail::matrix, T_element>::copy(this->getExpr(), output);
+  }
+
+  // Assigns all the given elements at once. If this matrix holds the only reference
+  // to an evaluated dense value, the elements are written directly into it.
+  void setElements(const std::vector<size_type>& rows, const std::vector<size_type>& cols, const std::vector<T_element>& values)
+  {
+    using namespace detail;
+    assert(rows.size() == values.size());
+    assert(cols.size() == values.size());
+
+    std::map<ElementIndex<matrix>, T_element> assignments;
+    for(std::size_t element = 0; element < rows.size(); ++element)
+      assignments[ElementIndex<matrix>(rows[element], cols[element])] = values[element];
+
+    Var<matrix, T_element>::setElements(assignments);
+  }
+
 protected:
+  template<typename StreamType>
+  static Matrix createDense(StreamType& stream)
+  {
+    return Matrix(*new detail::Literal<detail::matrix, T_element>(new detail::ConventionalMatrix<T_element>(stream)));
+  }
+
+  template<typename StreamType>
+  static Matrix createSparse(StreamType& stream)
+  {
+    return Matrix(*new detail::Literal<detail::matrix, T_element>(new detail::CRSMatrix<T_element>(stream)));
+  }
+
+  static Matrix createSparse(const size_type rows, const size_type cols, int* const rowPtr, int* const colInd, T_element* const values, 
+                             const StorageOwnership ownership)
+  {
+    return Matrix(*new detail::Literal<detail::matrix, T_element>(new detail::CRSMatrix<T_element>(rows, cols, rowPtr, colInd, values, ownership)));
+  }
+
   Matrix(detail::ExprNode<detail::matrix, T_element>& expr) : detail::Var<detail::matrix, T_element>(expr)
   {
   }
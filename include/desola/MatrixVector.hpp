@@ -19,6 +19,7 @@
 #define DESOLA_MATRIX_VECTOR_HPP
 
 #include <cstddef>
+#include <cassert>
 #include <boost/array.hpp>
 #include <desola/Desola_fwd.hpp>
 
@@ -197,12 +198,128 @@ public:
     v.visit(*this);
   }
 
+  virtual Maybe<std::size_t> nnz() const
+  {
+    return this->getOperand().nnz();
+  }
+
   virtual Maybe<double> getFlops() const
   {
     return 0.0;
   }
 };
 
+// Computes x*alpha + y*beta or x*alpha - y*beta in a single pass. These nodes are only
+// created by the AlgebraicSimplifier from pairwise operations on scaled vectors.
+template<typename T_element>
+class VectorAxpby : public ExprNode<vector, T_element>
+{
+private:
+  const PairwiseOp operation;
+  ExprNode<vector, T_element>* x;
+  ExprNode<scalar, T_element>* alpha;
+  ExprNode<vector, T_element>* y;
+  ExprNode<scalar, T_element>* beta;
+
+  template<typename T_replacement>
+  void updateImpl(ExprNode<T_replacement, T_element>& previous, ExprNode<T_replacement, T_element>& next)
+  {
+    if (ReplaceExprNode<vector, T_replacement, T_element>()(x, &previous, &next))
+      this->replaceDependency(&previous, &next);
+
+    if (ReplaceExprNode<scalar, T_replacement, T_element>()(alpha, &previous, &next))
+      this->replaceDependency(&previous, &next);
+
+    if (ReplaceExprNode<vector, T_replacement, T_element>()(y, &previous, &next))
+      this->replaceDependency(&previous, &next);
+
+    if (ReplaceExprNode<scalar, T_replacement, T_element>()(beta, &previous, &next))
+      this->replaceDependency(&previous, &next);
+  }
+
+public:
+  VectorAxpby(const PairwiseOp op, ExprNode<vector, T_element>& _x, ExprNode<scalar, T_element>& _alpha, 
+    ExprNode<vector, T_element>& _y, ExprNode<scalar, T_element>& _beta) : ExprNode<vector, T_element>(_x.getDims()), 
+    operation(op), x(&_x), alpha(&_alpha), y(&_y), beta(&_beta)
+  {
+    assert(operation == pair_add || operation == pair_sub);
+    this->registerDependency(x);
+    this->registerDependency(alpha);
+    this->registerDependency(y);
+    this->registerDependency(beta);
+  }
+
+  PairwiseOp getOperation() const
+  {
+    return operation;
+  }
+
+  inline ExprNode<vector, T_element>& getX()
+  {
+    return *x;
+  }
+
+  inline const ExprNode<vector, T_element>& getX() const
+  {
+    return *x;
+  }
+
+  inline ExprNode<scalar, T_element>& getAlpha()
+  {
+    return *alpha;
+  }
+
+  inline const ExprNode<scalar, T_element>& getAlpha() const
+  {
+    return *alpha;
+  }
+
+  inline ExprNode<vector, T_element>& getY()
+  {
+    return *y;
+  }
+
+  inline const ExprNode<vector, T_element>& getY() const
+  {
+    return *y;
+  }
+
+  inline ExprNode<scalar, T_element>& getBeta()
+  {
+    return *beta;
+  }
+
+  inline const ExprNode<scalar, T_element>& getBeta() const
+  {
+    return *beta;
+  }
+
+  virtual void update(ExprNode<scalar, T_element>& previous, ExprNode<scalar, T_element>& next)
+  {
+    updateImpl(previous, next);
+  }
+  
+  virtual void update(ExprNode<vector, T_element>& previous, ExprNode<vector, T_element>& next)
+  {
+    updateImpl(previous, next);
+  }
+  
+  virtual void update(ExprNode<matrix, T_element>& previous, ExprNode<matrix, T_element>& next)
+  {
+    updateImpl(previous, next);
+  }
+
+  void accept(ExpressionNodeVisitor<T_element>& v)
+  {
+    v.visit(*this);
+  }
+
+  virtual Maybe<double> getFlops() const
+  {
+    return 3.0 * this->getRowCount();
+  }
+};
+
 }
 
 }
@@ -0,0 +1,137 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef DESOLA_MULTI_VECTOR_HPP
+#define DESOLA_MULTI_VECTOR_HPP
+
+#include <cstddef>
+#include <cassert>
+#include <desola/Desola_fwd.hpp>
+
+//NOTE: A multi-vector holds k vectors of the same length as the columns of a
+//      dense n x k matrix, so the k elements of each row are stored
+//      together. A product with a sparse matrix is then a single sparse
+//      matrix-matrix multiply, which reads each non-zero and its column
+//      index once and applies it to all k columns.
+
+namespace desola
+{
+
+template<typename T_element>
+class MultiVector
+{
+public:
+  typedef std::size_t size_type;
+
+private:
+  Matrix<T_element> values;
+
+  explicit MultiVector(const Matrix<T_element>& v) : values(v)
+  {
+  }
+
+public:
+  template<typename T> friend const MultiVector<T> operator*(const Matrix<T>& left, const MultiVector<T>& right);
+
+  // Element i of vector j is stored at i*numCols() + j
+  MultiVector(const size_type rows, const size_type cols, const T_element initialValue = T_element()) : values(rows, cols, initialValue)
+  {
+  }
+
+  MultiVector(const size_type rows, const size_type cols, const T_element initialValue, Context& context) : values(rows, cols, initialValue, context)
+  {
+  }
+
+  MultiVector(const size_type rows, const size_type cols, T_element* const data, const StorageOwnership ownership) : values(rows, cols, data, ownership)
+  {
+  }
+
+  MultiVector(const size_type rows, const size_type cols, T_element* const data, const StorageOwnership ownership, Context& context) : 
+    values(rows, cols, data, ownership, context)
+  {
+  }
+
+  inline size_type numRows() const
+  {
+    return values.numRows();
+  }
+
+  // The number of vectors
+  inline size_type numCols() const
+  {
+    return values.numCols();
+  }
+
+  inline const Matrix<T_element>& getValues() const
+  {
+    return values;
+  }
+
+  const MultiVector operator+(const MultiVector& right) const
+  {
+    return MultiVector(values + right.values);
+  }
+
+  const MultiVector operator-(const MultiVector& right) const
+  {
+    return MultiVector(values - right.values);
+  }
+
+  const MultiVector operator*(const Scalar<T_element>& right) const
+  {
+    return MultiVector(values * right);
+  }
+
+  // Returns the numRows() x coefficients.numCols() multi-vector whose vectors are
+  // linear combinations of these vectors, as used to update a block Krylov basis
+  const MultiVector operator*(const Matrix<T_element>& coefficients) const
+  {
+    assert(numCols() == coefficients.numRows());
+    return MultiVector(values * coefficients);
+  }
+
+  // Returns the numCols() x right.numCols() matrix of the dot products of each
+  // pair of vectors. The transpose is not stored.
+  const Matrix<T_element> dot(const MultiVector& right) const
+  {
+    assert(numRows() == right.numRows());
+    return values.transpose() * right.values;
+  }
+
+  // Refers to count vectors starting at first, without copying them
+  const MultiVector columns(const size_type first, const size_type count) const
+  {
+    return MultiVector(values.slice(0, first, numRows(), count));
+  }
+
+  // Evaluates once and copies every element in the stored order
+  void copyTo(T_element* const output) const
+  {
+    values.copyTo(output);
+  }
+};
+
+// Multiplies each vector by a matrix in a single pass over the matrix
+template<typename T_element>
+const MultiVector<T_element> operator*(const Matrix<T_element>& left, const MultiVector<T_element>& right)
+{
+  assert(left.numCols() == right.numRows());
+  return MultiVector<T_element>(left * right.values);
+}
+
+}
+#endif
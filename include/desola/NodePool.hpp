@@ -0,0 +1,86 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef DESOLA_NODE_POOL_HPP
+#define DESOLA_NODE_POOL_HPP
+
+#include <cstddef>
+
+namespace desola
+{
+
+namespace detail
+{
+
+// Allocates expression nodes from per-thread free lists of fixed size blocks. Lists are refilled
+// from chunks shared between threads, so freed nodes are reused without returning to the heap.
+// A node may be freed on a different thread to the one which allocated it, so each thread's
+// lists are capped and excess blocks are moved to shared lists, from which other threads refill.
+// The blocks of a thread's lists are returned to the shared lists when it exits. Chunks are never
+// released.
+class NodePool
+{
+private:
+  struct FreeBlock
+  {
+    FreeBlock* next;
+  };
+
+  static const std::size_t granularity = 16;
+  static const std::size_t maxPooledSize = 512;
+  static const std::size_t classCount = maxPooledSize / granularity;
+  static const std::size_t chunkSize = 64 * 1024;
+
+  // Blocks move between the thread and shared lists in batches of half a chunk, and a thread
+  // keeps at most two batches of each size class
+  static const std::size_t batchBytes = chunkSize / 2;
+  static const std::size_t maxBatchesPerThread = 2;
+
+  struct ThreadCache;
+  struct SharedState;
+
+  static inline std::size_t getSizeClass(const std::size_t size)
+  {
+    return (size - 1) / granularity;
+  }
+
+  static inline std::size_t getBatchSize(const std::size_t sizeClass)
+  {
+    return batchBytes / ((sizeClass + 1) * granularity);
+  }
+
+  static SharedState& getSharedState();
+  static ThreadCache& getThreadCache();
+  static void refill(ThreadCache& cache, const std::size_t sizeClass);
+  static void release(ThreadCache& cache, const std::size_t sizeClass);
+
+public:
+  static void* allocate(const std::size_t size);
+  static void deallocate(void* const p, const std::size_t size);
+
+  // Pooled allocations made by the calling thread
+  static std::size_t getAllocationCount();
+
+  // Chunks requested from the heap by all threads
+  static std::size_t getChunkCount();
+};
+
+}
+
+}
+
+#endif
@@ -17,6 +17,7 @@
 
 #include <iosfwd>
 #include <cstddef>
+#include <vector>
 #include <desola/Desola_fwd.hpp>
 
 namespace desola
@@ -33,11 +34,12 @@ std::ostream& operator<< (std::ostream& o, const Vector<T_element>& v)
 {
   const std::size_t rows = v.numRows();
   o << "Vector: " << rows << std:: endl << "[";
-  for(std::size_t row=0; row<rows; ++row)
+  const typename Vector<T_element>::const_iterator end = v.end();
+  for(typename Vector<T_element>::const_iterator element = v.begin(); element != end; ++element)
   {
     o.width(10);
-    o << v(row).value();
-    if (row!=rows-1)
+    o << *element;
+    if (element+1 != end)
       o <<", ";
   }
   o << "]";
@@ -50,6 +52,10 @@ std::ostream& operator<< (std::ostream& o, const Matrix<T_element>& m)
   const std::size_t rows = m.numRows();
   const std::size_t cols = m.numCols();
 
+  std::vector<T_element> values(rows * cols);
+  if (!values.empty())
+    m.copyTo(&values[0]);
+
   o << "Matrix: " << rows << " * " << cols << std::endl << "[" << std::endl;
   for(std::size_t row=0; row<rows; ++row)
   {
@@ -57,7 +63,7 @@ std::ostream& operator<< (std::ostream& o, const Matrix<T_element>& m)
     for(std::size_t col=0; col<cols; ++col)
     {
       o.width(10);
-      o << m(row,col).value();
+      o << values[row * cols + col];
       if (col!=cols-1)
         o <<", ";
     }
@@ -0,0 +1,81 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef DESOLA_REDUCTION_HPP
+#define DESOLA_REDUCTION_HPP
+
+#include <cstddef>
+#include <boost/static_assert.hpp>
+
+//NOTE: Reductions are performed with a fixed number of interleaved partial
+//      sums which are then combined as a binary tree. The order of
+//      floating point operations depends only on the vector length, so
+//      results do not change if the reduction is later split across threads
+//      along lane boundaries. Element i is always added to lane
+//      i % reductionLanes. Generated code in tg/CodeGenerator.hpp must use
+//      the same ordering as the native functions below.
+
+namespace desola
+{
+
+namespace detail
+{
+
+// Must be a power of two for the tree combination.
+const std::size_t reductionLanes = 8;
+BOOST_STATIC_ASSERT((reductionLanes & (reductionLanes-1)) == 0);
+
+template<typename T_element>
+T_element combineReductionLanes(T_element partials[reductionLanes])
+{
+  for(std::size_t stride = reductionLanes/2; stride > 0; stride /= 2)
+    for(std::size_t lane = 0; lane < stride; ++lane)
+      partials[lane] += partials[lane+stride];
+
+  return partials[0];
+}
+
+template<typename T_element>
+T_element blockedDot(const T_element* left, const T_element* right, const std::size_t size)
+{
+  const std::size_t blocked = (size / reductionLanes) * reductionLanes;
+  T_element partials[reductionLanes];
+
+  for(std::size_t lane = 0; lane < reductionLanes; ++lane)
+    partials[lane] = T_element();
+
+  for(std::size_t base = 0; base < blocked; base += reductionLanes)
+    for(std::size_t lane = 0; lane < reductionLanes; ++lane)
+      partials[lane] += left[base+lane] * right[base+lane];
+
+  for(std::size_t lane = 0; blocked + lane < size; ++lane)
+    partials[lane] += left[blocked+lane] * right[blocked+lane];
+
+  return combineReductionLanes(partials);
+}
+
+template<typename T_element>
+T_element blockedSumOfSquares(const T_element* vector, const std::size_t size)
+{
+  return blockedDot(vector, vector, size);
+}
+
+}
+
+}
+
+#endif
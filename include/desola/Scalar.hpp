@@ -41,6 +41,11 @@ public:
   {
   }
 
+  Scalar(const T_element initialValue, Context& context) : detail::Var<detail::scalar, T_element>(*new detail::Literal<detail::scalar, T_element>(new detail::ConventionalScalar<T_element>(initialValue)))
+  {
+    this->bindContext(context);
+  }
+
   Scalar(const Scalar& s) : detail::Var<detail::scalar, T_element>(s.getExpr())
   {
   }
@@ -50,7 +55,7 @@ public:
     using namespace detail;
     if(this != &right)
     {
-      this->setExpr(right.getExpr());
+      this->assignExpr(right.getExpr());
     }
     return *this;
   }
@@ -144,6 +149,12 @@ public:
     this->getExpr().evaluate();
     return this->getExpr().getElementValue();
   }
+
+  // Evaluates on a worker thread, allowing further expressions to be built in the meantime
+  const Future<T_element> async_value() const
+  {
+    return Future<T_element>(*this, this->getExpr().evaluateAsync());
+  }
     
 protected:
   Scalar(detail::ExprNode<detail::scalar, T_element>& expr) : detail::Var<detail::scalar, T_element>(expr)
@@ -192,9 +203,33 @@ public:
     using namespace detail;
     if(this != &right)
     {
-      std::map<detail::ElementIndex<exprType>, detail::ExprNode<detail::scalar, T_element>*> mappings;
-      mappings[index] = &right.getExpr();
-      node.setExpr(*new ElementSet<exprType, T_element>(node.getExpr(), mappings));
+      // Our own element read may be the only other user of the assigned value
+      ElementGet<exprType, T_element>* const get = ExpressionNodeMatcher<ElementGet<exprType, T_element>, T_element>::match(this->getExpr());
+      const bool ownsGet = get != NULL && &get->getOperand() == &node.getExpr() && 
+        get->getInternalRequiredByCount() == 0 && get->getExternalRequiredByCount() == 1;
+      const std::size_t internalUsers = ownsGet ? 1 : 0;
+
+      Literal<scalar, T_element>* const literal = ExpressionNodeMatcher<Literal<scalar, T_element>, T_element>::match(right.getExpr());
+      if (literal != NULL)
+      {
+        typename ElementAssignment<exprType, T_element>::ValueMap values;
+        values.insert(std::make_pair(index, literal->getElementValue()));
+
+        if (ElementAssignment<exprType, T_element>::assignInPlace(node.getExpr(), values, internalUsers))
+          return *this;
+      }
+
+      ElementSet<exprType, T_element>* const pending = ElementAssignment<exprType, T_element>::getExtendable(node.getExpr(), internalUsers);
+      if (pending != NULL)
+      {
+        pending->addAssignment(index, right.getExpr());
+      }
+      else
+      {
+        std::map<detail::ElementIndex<exprType>, detail::ExprNode<detail::scalar, T_element>*> mappings;
+        mappings[index] = &right.getExpr();
+        node.setExpr(*new ElementSet<exprType, T_element>(node.getExpr(), mappings));
+      }
     }
     return *this;
   }
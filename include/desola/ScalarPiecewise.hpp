@@ -44,7 +44,7 @@ namespace
   class GetScalarPiecewiseSize<matrix, T_element>
   {
   public:
-    Maybe<double> getSize(const ExprNode<matrix, T_element>& e)
+    Maybe<double> operator()(const ExprNode<matrix, T_element>& e) const
     {
       return Maybe<double>(e.nnz());
     }
@@ -0,0 +1,216 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+
+#ifndef DESOLA_SMALL_VECTOR_HPP
+#define DESOLA_SMALL_VECTOR_HPP
+
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <iterator>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_pod.hpp>
+
+namespace desola
+{
+
+namespace detail
+{
+
+// A vector of POD values (in practice, pointers) which stores up to N
+// elements inline and only touches the heap when it grows beyond that.
+// Most expression nodes have one or two dependencies and users, so the
+// bookkeeping lists of a node rarely need an allocation of their own.
+// Erasure preserves order, as traversal order determines graph layout.
+
+template<typename T, std::size_t N>
+class SmallVector
+{
+private:
+  BOOST_STATIC_ASSERT(boost::is_pod<T>::value);
+  BOOST_STATIC_ASSERT(N > 0);
+
+  // 32-bit counts keep a two element vector of pointers to 24 bytes
+  unsigned count;
+  unsigned capacity;
+
+  union
+  {
+    T* heap;
+    T local[N];
+  } storage;
+
+  inline bool isLocal() const
+  {
+    return capacity == N;
+  }
+
+  inline T* data()
+  {
+    return isLocal() ? storage.local : storage.heap;
+  }
+
+  inline const T* data() const
+  {
+    return isLocal() ? storage.local : storage.heap;
+  }
+
+  void reserveExact(const unsigned newCapacity)
+  {
+    assert(newCapacity > capacity);
+    T* const newData = new T[newCapacity];
+    std::copy(begin(), end(), newData);
+
+    if (!isLocal())
+      delete[] storage.heap;
+
+    storage.heap = newData;
+    capacity = newCapacity;
+  }
+
+public:
+  typedef T value_type;
+  typedef T* iterator;
+  typedef const T* const_iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+  typedef std::size_t size_type;
+
+  SmallVector() : count(0), capacity(N)
+  {
+  }
+
+  SmallVector(const SmallVector& v) : count(0), capacity(N)
+  {
+    *this = v;
+  }
+
+  template<typename InputIterator>
+  SmallVector(InputIterator first, const InputIterator last) : count(0), capacity(N)
+  {
+    for(; first != last; ++first)
+      push_back(*first);
+  }
+
+  SmallVector& operator=(const SmallVector& v)
+  {
+    if (&v != this)
+    {
+      count = 0;
+
+      if (v.count > capacity)
+        reserveExact(v.count);
+
+      std::copy(v.begin(), v.end(), data());
+      count = v.count;
+    }
+    return *this;
+  }
+
+  inline iterator begin()
+  {
+    return data();
+  }
+
+  inline iterator end()
+  {
+    return data() + count;
+  }
+
+  inline const_iterator begin() const
+  {
+    return data();
+  }
+
+  inline const_iterator end() const
+  {
+    return data() + count;
+  }
+
+  inline const_reverse_iterator rbegin() const
+  {
+    return const_reverse_iterator(end());
+  }
+
+  inline const_reverse_iterator rend() const
+  {
+    return const_reverse_iterator(begin());
+  }
+
+  inline std::size_t size() const
+  {
+    return count;
+  }
+
+  inline bool empty() const
+  {
+    return count == 0;
+  }
+
+  inline T& operator[](const std::size_t index)
+  {
+    assert(index < count);
+    return data()[index];
+  }
+
+  inline const T& operator[](const std::size_t index) const
+  {
+    assert(index < count);
+    return data()[index];
+  }
+
+  void push_back(const T& value)
+  {
+    if (count == capacity)
+    {
+      // The value may live in our own storage
+      const T copy(value);
+      reserveExact(capacity * 2);
+      data()[count++] = copy;
+    }
+    else
+    {
+      data()[count++] = value;
+    }
+  }
+
+  iterator erase(const iterator location)
+  {
+    assert(location >= begin() && location < end());
+    std::copy(location + 1, end(), location);
+    --count;
+    return location;
+  }
+
+  void clear()
+  {
+    count = 0;
+  }
+
+  ~SmallVector()
+  {
+    if (!isLocal())
+      delete[] storage.heap;
+  }
+};
+
+}
+
+}
+
+#endif
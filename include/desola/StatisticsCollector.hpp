@@ -20,6 +20,7 @@
 
 #include "Desola_fwd.hpp"
 #include "Maybe.hpp"
+#include <boost/thread/mutex.hpp>
 
 namespace desola
 {
@@ -27,23 +28,35 @@ namespace desola
 class StatisticsCollector
 {
 private:
+  mutable boost::mutex mutex;
   double compileTime;
+  double setupTime;
   int compileCount;
   Maybe<double> flops;
+  int eliminatedCount;
+  int eliminatedMatrixVectorMultCount;
+  int eliminatedDotCount;
+  int rewriteCount;
+  int donationCount;
 	
   StatisticsCollector(const StatisticsCollector&);
   StatisticsCollector& operator=(const StatisticsCollector&);
-  StatisticsCollector();
-  
-  static StatisticsCollector statsCollector;
 
 public:
+  StatisticsCollector();
+
+  // Returns the statistics of the default context
   static StatisticsCollector& getStatisticsCollector();
 
   double getCompileTime() const;
   void addCompileTime(const double time);
   void resetCompileTime();
 
+  // Time spent gathering and ordering expression graphs for evaluation
+  double getSetupTime() const;
+  void addSetupTime(const double time);
+  void resetSetupTime();
+
   int getCompileCount() const;
   void incrementCompileCount();
   void resetCompileCount();
@@ -51,6 +64,23 @@ public:
   Maybe<double> getFlops() const;
   void addFlops(const Maybe<double>& flops);
   void resetFlops();
+
+  // Nodes removed by common subexpression elimination. Dots include two-norms.
+  int getEliminatedCount() const;
+  int getEliminatedMatrixVectorMultCount() const;
+  int getEliminatedDotCount() const;
+  void addEliminated(const int total, const int matrixVectorMults, const int dots);
+  void resetEliminated();
+
+  // Nodes replaced by algebraic simplification
+  int getRewriteCount() const;
+  void addRewrites(const int rewrites);
+  void resetRewrites();
+
+  // Results computed into the storage of a dead input
+  int getDonationCount() const;
+  void addDonations(const int donations);
+  void resetDonations();
 };
 
 }
@@ -0,0 +1,77 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef DESOLA_STORAGE_POOL_HPP
+#define DESOLA_STORAGE_POOL_HPP
+
+#include <cstddef>
+
+namespace desola
+{
+
+namespace detail
+{
+
+// Allocates the arrays holding vector and matrix values. Arrays are aligned to 64 bytes, so
+// generated loops may use aligned loads and stores. Freed arrays are kept on free lists keyed
+// by size class and handed out again, so solvers which repeatedly create values of the same
+// sizes stop calling into the heap. Cached arrays are released once their total size would
+// exceed the limit. With huge pages enabled, arrays of at least one huge page are aligned to
+// the huge page size and the kernel is advised to back them with transparent huge pages.
+//
+// The pool is shared by all threads and contexts. Its state is never destroyed, since values
+// held by static objects may be freed during static destruction.
+class StoragePool
+{
+private:
+  struct SharedState;
+
+  static const std::size_t smallGranularity = 64;
+  static const std::size_t largeGranularity = 4096;
+  static const std::size_t hugePageSize = 2 * 1024 * 1024;
+
+  static SharedState& getSharedState();
+  static std::size_t getSizeClass(const std::size_t bytes);
+  static void* allocateFromHeap(const std::size_t bytes, const bool useHugePages);
+
+public:
+  static const std::size_t alignment = 64;
+
+  static void* allocate(const std::size_t bytes);
+  static void deallocate(void* const p, const std::size_t bytes);
+
+  // A limit of zero disables caching of freed arrays
+  static void setLimit(const std::size_t bytes);
+  static std::size_t getLimit();
+
+  static void enableHugePages(const bool enabled);
+  static bool hugePagesEnabled();
+
+  // Returns all cached arrays to the heap
+  static void release();
+
+  static std::size_t getCachedBytes();
+
+  // Arrays requested from the heap rather than taken from the free lists
+  static std::size_t getHeapAllocationCount();
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,119 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef DESOLA_TASK_SCHEDULER_HPP
+#define DESOLA_TASK_SCHEDULER_HPP
+
+#include <cstddef>
+#include <deque>
+#include <utility>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/exception_ptr.hpp>
+
+namespace desola
+{
+
+class ConfigurationManager;
+
+namespace detail
+{
+
+class TaskScheduler;
+
+// Tracks a set of submitted tasks so a caller can wait for all of them
+class TaskGroup
+{
+private:
+  friend class TaskScheduler;
+
+  TaskGroup(const TaskGroup&);
+  TaskGroup& operator=(const TaskGroup&);
+
+  TaskScheduler& scheduler;
+  boost::mutex mutex;
+  boost::condition_variable finished;
+  std::size_t pending;
+  boost::exception_ptr error;
+
+public:
+  // The scheduler adopts the thread count and pinning of the given configuration
+  // if no other group is using it
+  TaskGroup(TaskScheduler& s, const ConfigurationManager& configurationManager);
+  ~TaskGroup();
+};
+
+// A thread pool shared by all evaluations in the process. Tasks are whole
+// evaluators, of which there are only a few per graph, so a single queue is
+// sufficient. Threads waiting on a TaskGroup execute that group's tasks while
+// they wait, so with a thread count of one everything runs on the caller, and
+// an application thread is never held up running another thread's evaluation.
+class TaskScheduler
+{
+public:
+  typedef boost::function<void ()> Task;
+
+private:
+  friend class TaskGroup;
+  typedef std::pair<Task, TaskGroup*> QueuedTask;
+
+  TaskScheduler(const TaskScheduler&);
+  TaskScheduler& operator=(const TaskScheduler&);
+
+  std::deque<QueuedTask> tasks;
+  boost::ptr_vector<boost::thread> workers;
+  boost::mutex configMutex;
+  boost::mutex stateMutex;
+  boost::condition_variable workAvailable;
+  std::size_t activeGroups;
+  std::size_t threadCount;
+  bool pinned;
+  bool stopping;
+
+  void beginGroup(const ConfigurationManager& configurationManager);
+  void endGroup();
+  void start(const std::size_t threads, const bool pin);
+  void stop();
+  void configure(const ConfigurationManager& configurationManager);
+  void workerLoop(const std::size_t index);
+  bool tryPop(const TaskGroup& group, QueuedTask& task);
+  bool tryRunTask(const TaskGroup& group);
+  static void runTask(QueuedTask& task);
+  static void pinCurrentThread(const std::size_t cpu);
+
+public:
+  TaskScheduler();
+
+  // Returns the scheduler shared by every context
+  static boost::shared_ptr<TaskScheduler> getTaskScheduler();
+
+  void submit(TaskGroup& group, const Task& task);
+  void wait(TaskGroup& group);
+
+  std::size_t getThreadCount() const;
+  ~TaskScheduler();
+};
+
+}
+
+}
+
+#endif
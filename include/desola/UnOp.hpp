@@ -21,6 +21,7 @@
 #include <cmath>
 #include <cassert>
 #include <boost/array.hpp>
+#include <boost/shared_ptr.hpp>
 #include <desola/Desola_fwd.hpp>
 
 namespace desola
@@ -138,6 +139,11 @@ public:
     this->getOperand().evaluate();
   }
 
+  virtual boost::shared_ptr< AsyncEvaluation<T_element> > internal_evaluate_async()
+  {
+    return this->getOperand().evaluateAsync();
+  }
+
   virtual T_element getElementValue()
   {
     return std::abs(this->getOperand().getElementValue());
@@ -166,6 +172,11 @@ public:
   { 
     this->getOperand().evaluate();
   }
+
+  virtual boost::shared_ptr< AsyncEvaluation<T_element> > internal_evaluate_async()
+  {
+    return this->getOperand().evaluateAsync();
+  }
 		        
   virtual T_element getElementValue()
   { 
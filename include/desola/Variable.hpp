@@ -18,6 +18,7 @@
 #ifndef DESOLA_VARIABLE_HPP
 #define DESOLA_VARIABLE_HPP
 
+#include <map>
 #include <desola/Desola_fwd.hpp>
 
 namespace desola
@@ -54,6 +55,16 @@ protected:
   virtual ~Variable() {}
 };
 
+// Keeps nodes alive while a graph is processed, even if the variables using them are reassigned or destroyed
+template<typename T_element>
+class NodePin : public Variable<T_element>
+{
+protected:
+  virtual void internal_update(ExprNode<scalar, T_element>& previous, ExprNode<scalar, T_element>& next) const {}
+  virtual void internal_update(ExprNode<vector, T_element>& previous, ExprNode<vector, T_element>& next) const {}
+  virtual void internal_update(ExprNode<matrix, T_element>& previous, ExprNode<matrix, T_element>& next) const {}
+};
+
 template<typename expressionType, typename T_element>
 class Var : public Variable<T_element>
 {
@@ -89,6 +100,11 @@ protected:
     e.unregisterRequiredBy(*this);
   }
 
+  void bindContext(Context& context) const
+  {
+    getExpr().bindContext(context);
+  }
+
   void setExpr(ExprNode<expressionType, T_element>& e) const
   {
     registerWith(e);
@@ -98,6 +114,38 @@ protected:
     expr = &e;
   }
 
+  // Assignments made by the user may evaluate the new expression to keep the graph within budget
+  void assignExpr(ExprNode<expressionType, T_element>& e) const
+  {
+    setExpr(e);
+    e.evaluateIfOverBudget();
+  }
+
+  void setElements(const std::map<ElementIndex<expressionType>, T_element>& values) const
+  {
+    ExprNode<expressionType, T_element>& current(getExpr());
+
+    if (ElementAssignment<expressionType, T_element>::assignInPlace(current, values, 0))
+      return;
+
+    std::map<ElementIndex<expressionType>, ExprNode<scalar, T_element>*> mappings;
+    typedef typename std::map<ElementIndex<expressionType>, T_element>::const_iterator ValueIterator;
+    for(ValueIterator valueIter = values.begin(); valueIter != values.end(); ++valueIter)
+      mappings[valueIter->first] = new Literal<scalar, T_element>(new ConventionalScalar<T_element>(valueIter->second));
+
+    ElementSet<expressionType, T_element>* const pending = ElementAssignment<expressionType, T_element>::getExtendable(current, 0);
+    if (pending != NULL)
+    {
+      typedef typename std::map<ElementIndex<expressionType>, ExprNode<scalar, T_element>*>::const_iterator MappingIterator;
+      for(MappingIterator mappingIter = mappings.begin(); mappingIter != mappings.end(); ++mappingIter)
+        pending->addAssignment(mappingIter->first, *mappingIter->second);
+    }
+    else
+    {
+      setExpr(*new ElementSet<expressionType, T_element>(current, mappings));
+    }
+  }
+
   ExprNode<expressionType, T_element>& getExpr() const
   {
     if (expr == NULL)
@@ -19,6 +19,10 @@
 #define DESOLA_VECTOR_HPP
 
 #include <cstddef>
+#include <cassert>
+#include <vector>
+#include <map>
+#include <boost/array.hpp>
 #include <desola/Desola_fwd.hpp>
 
 namespace desola
@@ -30,12 +34,15 @@ class Vector : public detail::Var<detail::vector, T_element>
 public:
   friend class Scalar<T_element>;
   friend class Matrix<T_element>;
+  friend class BatchVector<T_element>;
 
   // Typedefs for ITL
   typedef Scalar<T_element> value_type;
   typedef std::size_t size_type;
   typedef detail::vector expressionType;
 
+  typedef const T_element* const_iterator;
+
   Vector()
   {
   }
@@ -48,6 +55,26 @@ public:
   {
   }
 
+  Vector(const size_type rows, Context& context) : detail::Var<detail::vector, T_element>(*new detail::Literal<detail::vector, T_element>(new detail::ConventionalVector<T_element>(rows)))
+  {
+    this->bindContext(context);
+  }
+
+  Vector(const size_type rows, const T_element initialValue, Context& context) : detail::Var<detail::vector, T_element>(*new detail::Literal<detail::vector, T_element>(new detail::ConventionalVector<T_element>(rows, initialValue)))
+  {
+    this->bindContext(context);
+  }
+
+  // Uses the caller's storage of rows elements without copying it
+  Vector(const size_type rows, T_element* const data, const StorageOwnership ownership) : detail::Var<detail::vector, T_element>(*new detail::Literal<detail::vector, T_element>(new detail::ConventionalVector<T_element>(rows, data, ownership)))
+  {
+  }
+
+  Vector(const size_type rows, T_element* const data, const StorageOwnership ownership, Context& context) : detail::Var<detail::vector, T_element>(*new detail::Literal<detail::vector, T_element>(new detail::ConventionalVector<T_element>(rows, data, ownership)))
+  {
+    this->bindContext(context);
+  }
+
   Vector(const Vector& v) : detail::Var<detail::vector, T_element>(v.getExpr())
   {
   }
@@ -56,7 +83,7 @@ public:
   {
     if(this != &right)
     {
-      this->setExpr(right.getExpr());
+      this->assignExpr(right.getExpr());
     }
     return *this;
   }
@@ -69,7 +96,7 @@ public:
   const Vector& operator=(const Scalar<T_element>& right)
   {
     using namespace detail;
-    this->setExpr(*new ScalarPiecewise<vector, T_element>(piecewise_assign, this->getExpr(), right.getExpr()));
+    this->assignExpr(*new ScalarPiecewise<vector, T_element>(piecewise_assign, this->getExpr(), right.getExpr()));
     return *this;
   }
 
@@ -133,6 +160,18 @@ public:
     return Vector(*new Pairwise<vector, T_element>(pair_div, this->getExpr(), right.getExpr()));
   }
 
+  // Refers to length elements starting at offset and separated by stride, without copying them
+  const Vector slice(const size_type offset, const size_type length, const size_type stride = 1) const
+  {
+    using namespace detail;
+    // FIXME: Handle these errors better
+    assert(stride > 0);
+    assert(length == 0 || offset + (length-1) * stride < numRows());
+
+    const boost::array<std::size_t, 1> dims = { {length} };
+    return Vector(*new Slice<vector, T_element>(this->getExpr(), dims, ElementIndex<vector>(offset), ElementIndex<vector>(stride)));
+  }
+
   ScalarElement<detail::vector, T_element> operator()(const size_type row) const
   {
     using namespace detail;
@@ -140,6 +179,39 @@ public:
     return ScalarElement<vector, T_element>(*this, index);
   }
 
+  // Evaluates once and copies every element
+  void copyTo(T_element* const output) const
+  {
+    this->getExpr().evaluate();
+    detail::ElementReader<detail::vector, T_element>::copy(this->getExpr(), output);
+  }
+
+  // Evaluates once and reads the elements in place. Iterators are invalidated by any assignment to this vector.
+  const_iterator begin() const
+  {
+    this->getExpr().evaluate();
+    return detail::ElementReader<detail::vector, T_element>::getStorage(this->getExpr());
+  }
+
+  const_iterator end() const
+  {
+    return begin() + numRows();
+  }
+
+  // Assigns all the given elements at once. If this vector holds the only reference
+  // to an evaluated value, the elements are written directly into it.
+  void setElements(const std::vector<size_type>& rows, const std::vector<T_element>& values)
+  {
+    using namespace detail;
+    assert(rows.size() == values.size());
+
+    std::map<ElementIndex<vector>, T_element> assignments;
+    for(std::size_t element = 0; element < rows.size(); ++element)
+      assignments[ElementIndex<vector>(rows[element])] = values[element];
+
+    Var<vector, T_element>::setElements(assignments);
+  }
+
 protected:
   Vector(detail::ExprNode<detail::vector, T_element>& expr) : detail::Var<detail::vector, T_element>(expr)
   {
@@ -20,8 +20,11 @@
 
 #include <cassert>
 #include <complex>
+#include <vector>
+#include <algorithm>
 #include <itl/itl_tags.h>
 #include <itl/number_traits.h>
+#include <desola/Desola_fwd.hpp>
 
 namespace itl {
   
@@ -110,6 +113,127 @@ namespace itl {
   {
     y = A.trans_mult(x);
   }
+
+  // Batched solvers advance every system of a batch by one iteration per
+  // evaluation. System i has converged once |r_i| <= tol * |b_i|, which is
+  // tested for each system after reading back the batchSize vector of
+  // |r_i|^2. The step lengths of converged systems are zeroed, so they are
+  // left unchanged and their vanishing residuals are never divided by. A
+  // system with a zero right hand side has converged once its residual is
+  // exactly zero, as it is for a zero initial guess.
+  // Returns 0 if all systems converged and 1 otherwise.
+
+  template <typename T>
+  class batch_mask
+  {
+  private:
+    std::vector<T> thresholds;
+    desola::Vector<T> active;
+    desola::Vector<T> inactive;
+
+    static desola::Vector<T> create(const std::vector<T>& values)
+    {
+      T* const data = new T[values.size()];
+      std::copy(values.begin(), values.end(), data);
+      return desola::Vector<T>(values.size(), data, desola::ADOPT_STORAGE);
+    }
+
+  public:
+    batch_mask(const desola::BatchVector<T>& b, const T tol) : thresholds(b.batchSize()),
+      active(b.batchSize(), T(1)), inactive(b.batchSize(), T(0))
+    {
+      const desola::Vector<T> bb(b.dot(b));
+      const T* const norms = bb.begin();
+
+      for(std::size_t system = 0; system < thresholds.size(); ++system)
+        thresholds[system] = tol * tol * norms[system];
+    }
+
+    // Returns true once every system has converged
+    bool update(const desola::Vector<T>& rr)
+    {
+      const T* const norms = rr.begin();
+      std::vector<T> activeValues(thresholds.size()), inactiveValues(thresholds.size());
+      bool converged = true;
+
+      for(std::size_t system = 0; system < thresholds.size(); ++system)
+      {
+        const bool systemConverged = norms[system] <= thresholds[system];
+        activeValues[system] = systemConverged ? T(0) : T(1);
+        inactiveValues[system] = systemConverged ? T(1) : T(0);
+        converged = converged && systemConverged;
+      }
+
+      active = create(activeValues);
+      inactive = create(inactiveValues);
+      return converged;
+    }
+
+    // Elementwise division, giving zero for converged systems whatever their denominators
+    desola::Vector<T> ratio(const desola::Vector<T>& numerator, const desola::Vector<T>& denominator) const
+    {
+      return numerator.ele_mul(active).ele_div(denominator.ele_mul(active) + inactive);
+    }
+  };
+
+  template <typename T>
+  int batch_cg(const desola::BatchMatrix<T>& A, desola::BatchVector<T>& x, const desola::BatchVector<T>& b, 
+               const int max_iter, const T tol, int& iterations)
+  {
+    batch_mask<T> mask(b, tol);
+    desola::BatchVector<T> r(b - A * x);
+    desola::BatchVector<T> p(r);
+    desola::Vector<T> rho(r.dot(r));
+
+    for(iterations = 0; iterations < max_iter; ++iterations)
+    {
+      if (mask.update(rho))
+        return 0;
+
+      const desola::BatchVector<T> q(A * p);
+      const desola::Vector<T> alpha(mask.ratio(rho, p.dot(q)));
+      x = x + p.scaled(alpha);
+      r = r - q.scaled(alpha);
+
+      const desola::Vector<T> rhoNext(r.dot(r));
+      p = r + p.scaled(mask.ratio(rhoNext, rho));
+      rho = rhoNext;
+    }
+
+    return mask.update(rho) ? 0 : 1;
+  }
+
+  template <typename T>
+  int batch_bicgstab(const desola::BatchMatrix<T>& A, desola::BatchVector<T>& x, const desola::BatchVector<T>& b, 
+                     const int max_iter, const T tol, int& iterations)
+  {
+    batch_mask<T> mask(b, tol);
+    desola::BatchVector<T> r(b - A * x);
+    const desola::BatchVector<T> rtilde(r);
+    desola::BatchVector<T> p(r);
+    desola::Vector<T> rho(rtilde.dot(r));
+
+    for(iterations = 0; iterations < max_iter; ++iterations)
+    {
+      if (mask.update(r.dot(r)))
+        return 0;
+
+      const desola::BatchVector<T> v(A * p);
+      const desola::Vector<T> alpha(mask.ratio(rho, rtilde.dot(v)));
+      const desola::BatchVector<T> s(r - v.scaled(alpha));
+      const desola::BatchVector<T> t(A * s);
+      const desola::Vector<T> omega(mask.ratio(t.dot(s), t.dot(t)));
+      x = x + p.scaled(alpha) + s.scaled(omega);
+      r = s - t.scaled(omega);
+
+      const desola::Vector<T> rhoNext(rtilde.dot(r));
+      const desola::Vector<T> beta(mask.ratio(rhoNext, rho).ele_mul(mask.ratio(alpha, omega)));
+      p = r + (p - v.scaled(omega)).scaled(beta);
+      rho = rhoNext;
+    }
+
+    return mask.update(r.dot(r)) ? 0 : 1;
+  }
 }
 
 #endif
@@ -33,12 +33,14 @@ template<typename T_element> class PSquareRoot;
 template<typename resultType, typename leftType, typename rightType, typename T_element> class PBinOp;
 template<typename exprType, typename T_element> class PElementGet;
 template<typename exprType, typename T_element> class PElementSet;
+template<typename exprType, typename T_element> class PSlice;
 template<typename T_element> class PMatrixMult;
 template<typename T_element> class PMatrixVectorMult;
 template<typename T_element> class PTransposeMatrixVectorMult;
 template<typename T_element> class PVectorDot;
 template<typename T_element> class PVectorCross;
 template<typename T_element> class PVectorTwoNorm;
+template<typename T_element> class PVectorAxpby;
 template<typename T_element> class PMatrixTranspose;
 template<typename exprType, typename T_element> class PPairwise;
 template<typename exprType, typename T_element> class PScalarPiecewise;
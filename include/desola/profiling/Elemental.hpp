@@ -93,6 +93,25 @@ public:
   }
 };
 
+template<typename exprType, typename T_element>
+class PSlice : public PUnOp<exprType, exprType, T_element>
+{
+public:
+  bool isEqual(const PSlice& node, const std::map<const PExpressionNode<T_element>*, const PExpressionNode<T_element>*>& mappings) const
+  {
+    return PUnOp<exprType, exprType, T_element>::isEqual(node, mappings);
+  }
+
+  PSlice(PExprNode<exprType, T_element>& operand) : PUnOp<exprType, exprType, T_element>(operand)
+  {
+  }
+
+  virtual void accept(PExpressionNodeVisitor<T_element>& visitor)
+  {
+    visitor.visit(*this);
+  }  
+};
+
 }
 
 }
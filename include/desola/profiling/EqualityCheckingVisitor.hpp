@@ -83,6 +83,16 @@ public:
     checkMatch(e);
   }
 
+  virtual void visit(PSlice<vector, T_element>& e)
+  {
+    checkMatch(e);
+  }
+  
+  virtual void visit(PSlice<matrix, T_element>& e)
+  {
+    checkMatch(e);
+  }
+
   virtual void visit(PLiteral<scalar, T_element>& e)
   {
     checkMatch(e);
@@ -127,6 +137,11 @@ public:
   {
     checkMatch(e);
   }
+
+  virtual void visit(PVectorAxpby<T_element>& e)
+  {
+    checkMatch(e);
+  }
   
   virtual void visit(PMatrixTranspose<T_element>& e)
   {
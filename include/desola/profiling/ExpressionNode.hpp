@@ -20,6 +20,7 @@
 
 #include "Desola_profiling_fwd.hpp"
 #include <boost/shared_ptr.hpp>
+#include <boost/detail/atomic_count.hpp>
 #include <map>
 
 namespace desola
@@ -35,8 +36,9 @@ private:
   PExpressionNode(const PExpressionNode&);
   PExpressionNode& operator=(const PExpressionNode&);
 
-  int liveCount;
-  int deadCount;
+  // Updated from the destructors of monitored nodes, which may run on any thread
+  boost::detail::atomic_count liveCount;
+  boost::detail::atomic_count deadCount;
 
 public:
   PExpressionNode() : liveCount(0), deadCount(0)
@@ -57,7 +59,10 @@ public:
 
   EvaluationDirective getSuggestedEvaluationDirective() const
   {
-    if (liveCount-deadCount>=0 || (liveCount == deadCount && liveCount == 0))
+    const long live = liveCount;
+    const long dead = deadCount;
+
+    if (live-dead>=0 || (live == dead && live == 0))
     {
       return EVALUATE;
     }
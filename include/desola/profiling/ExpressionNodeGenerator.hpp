@@ -156,6 +156,11 @@ public:
   {
     handleNode(e, new PVectorTwoNorm<T_element>(getVector(e.getOperand())));
   }
+
+  virtual void visit(VectorAxpby<T_element>& e)
+  {
+    handleNode(e, new PVectorAxpby<T_element>(e.getOperation(), getVector(e.getX()), getScalar(e.getAlpha()), getVector(e.getY()), getScalar(e.getBeta())));
+  }
   
   virtual void visit(MatrixTranspose<T_element>& e)
   {
@@ -182,6 +187,16 @@ public:
     handleNode(e, new PElementSet<matrix, T_element>(getMatrix(e.getOperand()), getAssignments(e)));
   }
 
+  virtual void visit(Slice<vector, T_element>& e)
+  {
+    handleNode(e, new PSlice<vector, T_element>(getVector(e.getOperand())));
+  }
+
+  virtual void visit(Slice<matrix, T_element>& e)
+  {
+    handleNode(e, new PSlice<matrix, T_element>(getMatrix(e.getOperand())));
+  }
+
   virtual void visit(Literal<scalar, T_element>& e)
   {
     handleNode(e, new PLiteral<scalar, T_element>());
@@ -36,6 +36,9 @@ public:
   virtual void visit(PElementSet<vector, T_element>& e) = 0;
   virtual void visit(PElementSet<matrix, T_element>& e) = 0;
 
+  virtual void visit(PSlice<vector, T_element>& e) = 0;
+  virtual void visit(PSlice<matrix, T_element>& e) = 0;
+
   virtual void visit(PLiteral<scalar, T_element>& e) = 0;
   virtual void visit(PLiteral<vector, T_element>& e) = 0;
   virtual void visit(PLiteral<matrix, T_element>& e) = 0;
@@ -46,6 +49,7 @@ public:
   virtual void visit(PVectorDot<T_element>& e) = 0;
   virtual void visit(PVectorCross<T_element>& e) = 0;
   virtual void visit(PVectorTwoNorm<T_element>& e) = 0;
+  virtual void visit(PVectorAxpby<T_element>& e) = 0;
   virtual void visit(PMatrixTranspose<T_element>& e) = 0;
 
   virtual void visit(PPairwise<scalar, T_element>& e) = 0;
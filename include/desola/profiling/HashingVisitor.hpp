@@ -103,6 +103,24 @@ private:
     return seed;
   }
   
+  std::size_t getNumbering(const PExpressionNode<T_element>& node) const
+  {
+    const typename std::map<const PExpressionNode<T_element>*, int>::const_iterator numbering = nodeNumberings.find(&node);
+    assert(numbering != nodeNumberings.end());
+    return numbering->second;
+  }
+
+  std::size_t hashVectorAxpby(const PVectorAxpby<T_element>& node) const
+  {
+    std::size_t seed = hashExprNode(node);
+    boost::hash_combine(seed, node.getOperation());
+    boost::hash_combine(seed, getNumbering(node.getX()));
+    boost::hash_combine(seed, getNumbering(node.getAlpha()));
+    boost::hash_combine(seed, getNumbering(node.getY()));
+    boost::hash_combine(seed, getNumbering(node.getBeta()));
+    return seed;
+  }
+  
 public:
 
   PHashingVisitor(const std::map<const PExpressionNode<T_element>*, int>& numberings) : nodeNumberings(numberings), hash(0)
@@ -134,6 +152,16 @@ public:
     boost::hash_combine(hash, hashElementSet(e));
   }
 
+  virtual void visit(PSlice<vector, T_element>& e)
+  {
+    boost::hash_combine(hash, hashUnOp(e));
+  }
+  
+  virtual void visit(PSlice<matrix, T_element>& e)
+  {
+    boost::hash_combine(hash, hashUnOp(e));
+  }
+
   virtual void visit(PLiteral<scalar, T_element>& e)
   {
     boost::hash_combine(hash, hashExprNode(e));
@@ -178,6 +206,11 @@ public:
   {
     boost::hash_combine(hash, hashUnOp(e));
   }
+
+  virtual void visit(PVectorAxpby<T_element>& e)
+  {
+    boost::hash_combine(hash, hashVectorAxpby(e));
+  }
   
   virtual void visit(PMatrixTranspose<T_element>& e)
   {
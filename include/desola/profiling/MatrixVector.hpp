@@ -20,6 +20,7 @@
 
 #include "Desola_profiling_fwd.hpp"
 #include <map>
+#include <cassert>
 
 namespace desola
 {
@@ -160,6 +161,68 @@ public:
   }
 };
 
+template<typename T_element>
+class PVectorAxpby : public PExprNode<vector, T_element>
+{
+private:
+  const PairwiseOp op;
+  PExprNode<vector, T_element>* x;
+  PExprNode<scalar, T_element>* alpha;
+  PExprNode<vector, T_element>* y;
+  PExprNode<scalar, T_element>* beta;
+
+public:
+  bool isEqual(const PVectorAxpby& node, const std::map<const PExpressionNode<T_element>*, const PExpressionNode<T_element>*>& mappings) const
+  {
+    assert(mappings.find(x) != mappings.end());
+    assert(mappings.find(alpha) != mappings.end());
+    assert(mappings.find(y) != mappings.end());
+    assert(mappings.find(beta) != mappings.end());
+
+    return PExprNode<vector, T_element>::isEqual(node, mappings) &&
+           op == node.op &&
+           mappings.find(x)->second == node.x &&
+           mappings.find(alpha)->second == node.alpha &&
+           mappings.find(y)->second == node.y &&
+           mappings.find(beta)->second == node.beta;
+  }
+
+  PVectorAxpby(const PairwiseOp o, PExprNode<vector, T_element>& _x, PExprNode<scalar, T_element>& _alpha, 
+    PExprNode<vector, T_element>& _y, PExprNode<scalar, T_element>& _beta) : op(o), x(&_x), alpha(&_alpha), y(&_y), beta(&_beta)
+  {
+  }
+
+  const PairwiseOp getOperation() const
+  {
+    return op;
+  }
+
+  inline const PExprNode<vector, T_element>& getX() const
+  {
+    return *x;
+  }
+
+  inline const PExprNode<scalar, T_element>& getAlpha() const
+  {
+    return *alpha;
+  }
+
+  inline const PExprNode<vector, T_element>& getY() const
+  {
+    return *y;
+  }
+
+  inline const PExprNode<scalar, T_element>& getBeta() const
+  {
+    return *beta;
+  }
+
+  virtual void accept(PExpressionNodeVisitor<T_element>& visitor)
+  {
+    visitor.visit(*this);
+  }
+};
+
 }
 
 }
@@ -22,6 +22,7 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/bind.hpp>
 #include <boost/bind/apply.hpp>
+#include <boost/thread/mutex.hpp>
 #include <memory>
 #include <map>
 #include <cstddef>
@@ -39,14 +40,10 @@ private:
   Profiler(const Profiler&);
   Profiler& operator=(const Profiler&);
 	  
-  static Profiler<T_element> profiler;
   typedef std::map<std::size_t, boost::shared_ptr< PExpressionGraph<T_element> > > T_cachedProfileMap;
+  boost::mutex mutex;
   T_cachedProfileMap cachedProfiles;
 
-  Profiler()
-  {
-  }
-
   void addMonitors(ExpressionGraph<T_element>& graph, boost::shared_ptr< PExpressionGraph<T_element> > profilingGraph)
   {
     assert(graph.nodeCount() == profilingGraph->nodeCount());
@@ -85,9 +82,8 @@ private:
   }
   
 public:
-  static Profiler& getProfiler()
+  Profiler(ConfigurationManager& configurationManager) : Cache(configurationManager)
   {
-    return profiler;
   }
   
   std::auto_ptr< ExpressionGraph<T_element> > getAnnotatedExpressionGraph(ExpressionGraph<T_element>& graph, ExpressionNode<T_element>& current)
@@ -95,15 +91,18 @@ public:
     boost::shared_ptr< PExpressionGraph<T_element> > profilingGraph(new PExpressionGraph<T_element>(graph));
     const std::size_t hash = boost::hash< PExpressionGraph<T_element> >()(*profilingGraph);
 
-    const typename T_cachedProfileMap::iterator cachedProfileIterator(cachedProfiles.find(hash)); 
-
-    if (cachedProfileIterator != cachedProfiles.end() && (*profilingGraph)==(*cachedProfileIterator->second))
     {
-      profilingGraph = cachedProfileIterator->second;
-    }
-    else
-    {
-      cachedProfiles[hash] = profilingGraph;
+      boost::mutex::scoped_lock lock(mutex);
+      const typename T_cachedProfileMap::iterator cachedProfileIterator(cachedProfiles.find(hash)); 
+
+      if (cachedProfileIterator != cachedProfiles.end() && (*profilingGraph)==(*cachedProfileIterator->second))
+      {
+        profilingGraph = cachedProfileIterator->second;
+      }
+      else
+      {
+        cachedProfiles[hash] = profilingGraph;
+      }
     }
 
     addMonitors(graph, profilingGraph);
@@ -118,6 +117,7 @@ public:
 
   virtual void flush()
   {
+    boost::mutex::scoped_lock lock(mutex);
     cachedProfiles.clear();
   }
 
@@ -126,8 +126,6 @@ public:
   }
 };
 
-template<typename T_element> Profiler<T_element> Profiler<T_element>::profiler;
-
 }
 
 }
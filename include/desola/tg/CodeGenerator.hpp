@@ -19,6 +19,7 @@
 #define DESOLA_TG_CODE_GENERATOR_HPP
 
 #include <cstddef>
+#include <typeinfo>
 #include <utility>
 #include <string>
 #include <map>
@@ -26,6 +27,8 @@
 #include <boost/bind.hpp>
 #include <boost/ref.hpp>
 #include <boost/tuple/tuple.hpp>
+#include <boost/function.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 #include <TaskGraph>
 #include "Desola_tg_fwd.hpp"
 
@@ -88,6 +91,48 @@ private:
   }
 
 
+  static TGScalarExpr<T_element> dotTerm(TGVector<T_element>& left, TGVector<T_element>& right, const tg::TaskExpression& index)
+  {
+    return left.getExpression(index).mul(right.getExpression(index));
+  }
+
+  // Same summation order as blockedDot() in Reduction.hpp. The loop is unrolled by the lane count
+  // with one scalar accumulator per lane, and the trailing elements are added to the first lanes.
+  void blockedReduction(TGScalar<T_element>& result, const std::size_t size, const boost::function<TGScalarExpr<T_element> (const tg::TaskExpression&)>& term)
+  {
+    using namespace tg;
+
+    const unsigned lanes = reductionLanes;
+    const std::size_t blocks = size / lanes;
+    boost::ptr_vector< TaskScalarVariableWrapper<T_element> > partials;
+
+    for(unsigned lane = 0; lane < lanes; ++lane)
+    {
+      partials.push_back(new TaskScalarVariableWrapper<T_element>(false, generator.getName("partial")));
+      partials.back().instantiate();
+      *partials.back() = T_element();
+    }
+
+    if (blocks > 0)
+    {
+      tVarNamed(unsigned, block, getIndexName().c_str());
+      tFor(block, 0u, blocks-1)
+      {
+        for(unsigned lane = 0; lane < lanes; ++lane)
+          *partials[lane] += term(block*lanes + lane).getExpression();
+      }
+    }
+
+    for(unsigned lane = 0; blocks*lanes + lane < size; ++lane)
+      *partials[lane] += term(TaskExpression(static_cast<unsigned>(blocks*lanes + lane))).getExpression();
+
+    for(unsigned stride = lanes/2; stride > 0; stride /= 2)
+      for(unsigned lane = 0; lane < stride; ++lane)
+        *partials[lane] += *partials[lane+stride];
+
+    result.setExpression(TGScalarExpr<T_element>(*partials[0]));
+  }
+
   static void matrixMultKernel(NameGenerator& generator, TGMatrix<T_element>& b, TGMatrix<T_element>& c, const tg::TaskExpression& row, const tg::TaskExpression& col, const TGScalarExpr<T_element>& value)
   {
     using namespace tg;
@@ -99,6 +144,16 @@ private:
     }
   }
 
+  static void transposeKernel(NameGenerator& generator, TGMatrix<T_element>& result, const tg::TaskExpression& row, const tg::TaskExpression& col, const TGScalarExpr<T_element>& value)
+  {
+    result.setExpression(generator, col, row, value);
+  }
+
+  static void copyKernel(NameGenerator& generator, TGMatrix<T_element>& result, const tg::TaskExpression& row, const tg::TaskExpression& col, const TGScalarExpr<T_element>& value)
+  {
+    result.setExpression(generator, row, col, value);
+  }
+
 public:
   TGCodeGenerator(TGExpressionGraph<T_element>& g) : prefix("index"), generator(g.getNameGenerator())
   {
@@ -143,6 +198,56 @@ public:
     std::for_each(assignments.begin(), assignments.end(), boost::bind(setMatrixElement, boost::ref(generator), boost::ref(newMatrix), _1));
   }
 
+  virtual void visit(TGSlice<tg_vector, T_element>& e)
+  {
+    using namespace tg;
+
+    TGVector<T_element>& result(e.getInternal());
+    TGVector<T_element>& vector(e.getOperand().getInternal());
+
+    // Views are indexed in place by their consumers
+    if (typeid(result) == typeid(TGSlicedVector<T_element>))
+      return;
+
+    const TGSlicedVector<T_element> slice(vector, result.getRows(), e.getOffset().getRow(), e.getStride().getRow());
+
+    tVarNamed(unsigned, i, getIndexName().c_str());
+    tFor(i, 0u, result.getRows()-1)
+    {
+      result.setExpression(i, slice.getExpression(i));
+    }
+  }
+
+  virtual void visit(TGSlice<tg_matrix, T_element>& e)
+  {
+    using namespace tg;
+
+    TGMatrix<T_element>& result(e.getInternal());
+    TGMatrix<T_element>& matrix(e.getOperand().getInternal());
+
+    if (typeid(result) == typeid(TGSlicedMatrix<T_element>))
+      return;
+
+    const TGSlicedMatrix<T_element> slice(matrix, result.getRows(), result.getCols(), 
+      e.getOffset().getRow(), e.getOffset().getCol(), e.getStride().getRow(), e.getStride().getCol());
+
+    tVarNamed(unsigned, i, getIndexName().c_str());
+    tVarNamed(unsigned, j, getIndexName().c_str());
+
+    tFor(i, 0u, result.getRows()-1)
+    {
+      tFor(j, 0u, result.getCols()-1)
+      {
+        result.setExpression(generator, i, j, TGScalarExpr<T_element>());
+      }
+    }
+
+    typename TGMatrix<T_element>::MatrixIterationCallback kernel =
+      boost::bind(copyKernel, _1, boost::ref(result), _2, _3, _4);
+
+    slice.iterateSparse(generator, kernel);
+  }
+
   virtual void visit(TGElementGet<tg_vector, T_element>& e)
   {
     using namespace tg;
@@ -264,13 +369,7 @@ public:
     TGVector<T_element>& left(e.getLeft().getInternal());
     TGVector<T_element>& right(e.getRight().getInternal());
 
-    tVarNamed(unsigned, i, getIndexName().c_str());
-
-    result.setExpression(TGScalarExpr<T_element>());
-    tFor(i, 0u, left.getRows()-1)
-    {
-      result.addExpression(left.getExpression(i).mul(right.getExpression(i)));
-    }
+    blockedReduction(result, left.getRows(), boost::bind(dotTerm, boost::ref(left), boost::ref(right), _1));
   }
  
   virtual void visit(TGVectorCross<T_element>& e)
@@ -292,15 +391,27 @@ public:
 
     TGScalar<T_element>& result(e.getInternal());
     TGVector<T_element>& vector(e.getOperand().getInternal());
-   
-    tVarNamed(unsigned, i, getIndexName().c_str());
 
-    result.setExpression(TGScalarExpr<T_element>());
-    tFor(i, 0u, vector.getRows()-1)
+    blockedReduction(result, vector.getRows(), boost::bind(dotTerm, boost::ref(vector), boost::ref(vector), _1));
+    result.setExpression(result.getExpression().sqrt());
+  }
+
+  // Scaling is applied in the same order as by ScalarPiecewise, so results match the unfused form
+  virtual void visit(TGVectorAxpby<T_element>& e)
+  {
+    using namespace tg;
+
+    TGVector<T_element>& result(e.getInternal());
+    TGVector<T_element>& x(e.getX().getInternal());
+    TGScalar<T_element>& alpha(e.getAlpha().getInternal());
+    TGVector<T_element>& y(e.getY().getInternal());
+    TGScalar<T_element>& beta(e.getBeta().getInternal());
+
+    tVarNamed(unsigned, i, getIndexName().c_str());
+    tFor(i, 0u, result.getRows()-1)
     {
-      result.addExpression(vector.getExpression(i).mul(vector.getExpression(i)));
+      result.setExpression(i, performOp(e.getOperation(), x.getExpression(i).mul(alpha.getExpression()), y.getExpression(i).mul(beta.getExpression())));
     }
-    result.setExpression(result.getExpression().sqrt());
   }
  
   virtual void visit(TGMatrixTranspose<T_element>& e)
@@ -310,16 +421,25 @@ public:
     TGMatrix<T_element>& result(e.getInternal());
     TGMatrix<T_element>& matrix(e.getOperand().getInternal());
 
+    // Views are indexed in place by their consumers
+    if (typeid(result) == typeid(TGTransposedMatrix<T_element>))
+      return;
+
     tVarNamed(unsigned, i, getIndexName().c_str());
     tVarNamed(unsigned, j, getIndexName().c_str());
 
-    tFor(i, 0u, matrix.getRows()-1)
+    tFor(i, 0u, result.getRows()-1)
     {
-      tFor(j, 0u, matrix.getCols()-1)
+      tFor(j, 0u, result.getCols()-1)
       {
-        result.setExpression(generator, j, i, matrix.getExpression(generator, i, j));
+        result.setExpression(generator, i, j, TGScalarExpr<T_element>());
       }
     }
+
+    typename TGMatrix<T_element>::MatrixIterationCallback kernel =
+      boost::bind(transposeKernel, _1, boost::ref(result), _2, _3, _4);
+
+    matrix.iterateSparse(generator, kernel);
   }
 
   virtual void visit(TGPairwise<tg_scalar, T_element>& e)
@@ -20,6 +20,7 @@
 
 #include "NameGenerator.hpp"
 #include "ParameterHolder.hpp"
+#include "CodeGenerationLock.hpp"
 #include "Exceptions.hpp"
 #include "Traits.hpp"
 #include "ExpressionNode.hpp"
@@ -48,6 +48,7 @@ enum TGScalarPiecewiseOp
 // Common
 class NameGenerator;
 class ParameterHolder;
+class CodeGenerationLock;
 class TGInvalidOperationError;
 
 template<typename exprType, typename T_element> struct ExprTGTraits;
@@ -65,12 +66,14 @@ template<typename T_element> class TGHashingVisitor;
 template<typename T_element> class TGEqualityCheckingVisitor;
 template<typename exprType, typename T_element> class TGElementGet;
 template<typename exprType, typename T_element> class TGElementSet;
+template<typename exprType, typename T_element> class TGSlice;
 template<typename exprType, typename T_element> class TGLiteral;
 template<typename T_element> class TGMatrixMult;
 template<typename T_element> class TGMatrixVectorMult;
 template<typename T_element> class TGVectorDot;
 template<typename T_element> class TGVectorCross;
 template<typename T_element> class TGVectorTwoNorm;
+template<typename T_element> class TGVectorAxpby;
 template<typename T_element> class TGMatrixTranspose;
 template<typename exprType, typename T_element> class TGPairwise;
 template<typename exprType, typename T_element> class TGScalarPiecewise;
@@ -102,6 +105,9 @@ template<typename T_elementType> class TGConventionalScalar;
 template<typename T_elementType> class TGConventionalVector;
 template<typename T_elementType> class TGConventionalMatrix;
 template<typename T_elementType> class TGCRSMatrix;
+template<typename T_elementType> class TGTransposedMatrix;
+template<typename T_elementType> class TGSlicedVector;
+template<typename T_elementType> class TGSlicedMatrix;
 
 // Creates TaskGraph Evaluator Storage Representations from Generic Representations
 template<typename T_elementType> class TGScalarGen;
@@ -64,6 +64,43 @@ public:
   }
 };
 
+template<typename exprType, typename T_element>
+class TGSlice : public TGUnOp<exprType, exprType, T_element>
+{
+private:
+  const TGElementIndex<exprType> offset;
+  const TGElementIndex<exprType> stride;
+
+public:
+  bool isEqual(const TGSlice& node, const std::map<const TGExpressionNode<T_element>*, const TGExpressionNode<T_element>*>& mappings) const
+  {
+    return TGUnOp<exprType, exprType, T_element>::isEqual(node, mappings) &&
+    offset == node.offset && stride == node.stride;
+  }
+  
+  TGSlice(typename TGInternalType<exprType, T_element>::type* internal, 
+          const TGOutputReference<exprType, T_element>& o, 
+          const TGElementIndex<exprType>& off, const TGElementIndex<exprType>& s) : TGUnOp<exprType, exprType, T_element>(internal, o), 
+                                                                                    offset(off), stride(s)
+  {
+  }
+
+  inline const TGElementIndex<exprType>& getOffset() const
+  {
+    return offset;
+  }
+
+  inline const TGElementIndex<exprType>& getStride() const
+  {
+    return stride;
+  }
+
+  virtual void accept(TGExpressionNodeVisitor<T_element>& v)
+  {
+    v.visit(*this);
+  }
+};
+
 template<typename exprType, typename T_element>
 class TGElementSet : public TGExprNode<exprType, T_element>
 {
@@ -83,6 +83,16 @@ public:
     checkMatch(e);
   }
 
+  virtual void visit(TGSlice<tg_vector, T_element>& e)
+  {
+    checkMatch(e);
+  }
+  
+  virtual void visit(TGSlice<tg_matrix, T_element>& e)
+  {
+    checkMatch(e);
+  }
+
   virtual void visit(TGLiteral<tg_scalar, T_element>& e)
   {
     checkMatch(e);
@@ -127,6 +137,11 @@ public:
   {
     checkMatch(e);
   }
+
+  virtual void visit(TGVectorAxpby<T_element>& e)
+  {
+    checkMatch(e);
+  }
   
   virtual void visit(TGMatrixTranspose<T_element>& e)
   {
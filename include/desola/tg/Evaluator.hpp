@@ -20,6 +20,10 @@
 
 #include <boost/shared_ptr.hpp>
 #include <boost/functional/hash.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/atomic.hpp>
 #include <vector>
 #include <map>
 #include <set>
@@ -33,23 +37,130 @@ namespace desola
 namespace detail
 {
 
+// Most evaluations are cache hits, so lookups read an immutable snapshot of
+// the cache without taking locks. Each thread keeps its own reference to the
+// current snapshot and only refreshes it, under the writer lock, when the
+// generation counter shows an insert or flush has published a new one.
 template<typename T_element>
 class TGCache : public Cache
 {
 public:
-  typedef std::map<std::size_t, boost::shared_ptr< TGExpressionGraph<T_element> > > T_cachedGraphMap;
+  typedef TGExpressionGraph<T_element> T_graph;
+  // Several instances of the same graph may be cached so that identical
+  // evaluations on different threads do not serialise on one compiled object.
+  typedef std::map<std::size_t, std::vector< boost::shared_ptr<T_graph> > > T_cachedGraphMap;
+
+  // Releases a claimed graph for use by other evaluations when destroyed
+  class Claim
+  {
+  private:
+    Claim(const Claim&);
+    Claim& operator=(const Claim&);
+
+    T_graph* graph;
+
+  public:
+    Claim() : graph(NULL)
+    {
+    }
+
+    void reset(T_graph& g)
+    {
+      assert(graph == NULL);
+      graph = &g;
+    }
+
+    ~Claim()
+    {
+      if (graph != NULL)
+        graph->release();
+    }
+  };
+
 private:
-  T_cachedGraphMap cache;
+  typedef boost::shared_ptr<const T_cachedGraphMap> T_snapshot;
+
+  struct ReaderState
+  {
+    unsigned long generation;
+    T_snapshot snapshot;
+
+    ReaderState() : generation(0)
+    {
+    }
+  };
+
+  boost::mutex writerMutex;
+  T_snapshot current;
+  boost::atomic<unsigned long> generation;
+  boost::thread_specific_ptr<ReaderState> readerState;
+
+  // Called with the writer lock held
+  void publish(const T_snapshot& snapshot)
+  {
+    current = snapshot;
+    generation.fetch_add(1, boost::memory_order_release);
+  }
+
+  const T_cachedGraphMap& getSnapshot()
+  {
+    const unsigned long latest = generation.load(boost::memory_order_acquire);
+    ReaderState* state = readerState.get();
+
+    if (state == NULL)
+    {
+      state = new ReaderState();
+      readerState.reset(state);
+    }
+
+    if (state->generation != latest)
+    {
+      boost::mutex::scoped_lock lock(writerMutex);
+      state->snapshot = current;
+      state->generation = generation.load(boost::memory_order_relaxed);
+    }
+
+    return *state->snapshot;
+  }
   
 public:
+  TGCache(ConfigurationManager& configurationManager) : Cache(configurationManager), current(new T_cachedGraphMap()), generation(1)
+  {
+  }
+
   virtual void flush()
   {
-    cache.clear();
+    boost::mutex::scoped_lock lock(writerMutex);
+    publish(T_snapshot(new T_cachedGraphMap()));
+  }
+
+  // Returns an idle cached graph equal to the supplied one, claimed for execution
+  boost::shared_ptr<T_graph> acquire(const std::size_t hash, const T_graph& graph, Claim& claim)
+  {
+    const T_cachedGraphMap& snapshot(getSnapshot());
+    const typename T_cachedGraphMap::const_iterator bucket = snapshot.find(hash);
+
+    if (bucket != snapshot.end())
+    {
+      BOOST_FOREACH(const boost::shared_ptr<T_graph>& cached, bucket->second)
+      {
+        if (graph == *cached && cached->tryClaim())
+        {
+          claim.reset(*cached);
+          return cached;
+        }
+      }
+    }
+
+    return boost::shared_ptr<T_graph>();
   }
 
-  T_cachedGraphMap& getCachedGraphs()
+  void insert(const std::size_t hash, const boost::shared_ptr<T_graph>& graph)
   {
-    return cache;
+    boost::mutex::scoped_lock lock(writerMutex);
+    const boost::shared_ptr<T_cachedGraphMap> updated(new T_cachedGraphMap(*current));
+    (*updated)[hash].push_back(graph);
+    publish(updated);
   }
 };
 
@@ -57,8 +168,6 @@ template<typename T_element>
 class TGEvaluator : public Evaluator<T_element>
 {
 private:
-  static TGCache<T_element> graphCache;
-	
   TGEvaluator(const TGEvaluator&);
   TGEvaluator& operator=(const TGEvaluator&);
 	
@@ -69,7 +178,7 @@ private:
   std::vector<ExpressionNode<T_element>*> claimed;
 
 public:
-  TGEvaluator(EvaluationStrategy<T_element>& s) : evaluated(false), strategy(s), graph(new TGExpressionGraph<T_element>()), objectGenerator(*this)
+  TGEvaluator(EvaluationStrategy<T_element>& s) : evaluated(false), strategy(s), graph(new TGExpressionGraph<T_element>(s.getContext())), objectGenerator(*this)
   {
   }
 
@@ -99,7 +208,9 @@ public:
   
   virtual void evaluate()
   {
-    const ConfigurationManager& configurationManager(ConfigurationManager::getConfigurationManager());	
+    Context& context(strategy.getContext());
+    const ConfigurationManager& configurationManager(context.getConfigurationManager());
+    TGCache<T_element>& graphCache(context.template getCache< TGCache<T_element> >());
     assert(!evaluated); 
     evaluated = true;
 
@@ -108,22 +219,34 @@ public:
       graph->performHighLevelFusion();
 
     const std::size_t hash = boost::hash< TGExpressionGraph<T_element> >()(*graph);
-    typename TGCache<T_element>::T_cachedGraphMap& cachedGraphMap(graphCache.getCachedGraphs());
-    const typename TGCache<T_element>::T_cachedGraphMap::iterator cachedGraphIterator = cachedGraphMap.find(hash);
 
     ParameterHolder parameterHolder;
     objectGenerator.addTaskGraphMappings(parameterHolder);
+
+    typename TGCache<T_element>::Claim claim;
+    boost::shared_ptr< TGExpressionGraph<T_element> > cachedGraph;
+
+    if (configurationManager.codeCachingEnabled())
+      cachedGraph = graphCache.acquire(hash, *graph, claim);
 	    
-    if (configurationManager.codeCachingEnabled() && cachedGraphIterator != cachedGraphMap.end() && 
-	(*graph)==(*cachedGraphIterator->second))
+    if (cachedGraph)
     {
-      graph = cachedGraphIterator->second;
+      graph = cachedGraph;
     }
     else
     {
-      graph->generateCode();
-      graph->compile();
-      cachedGraphMap[hash] = graph;
+      {
+        CodeGenerationLock codeGenerationLock;
+        graph->generateCode();
+        graph->compile();
+      }
+
+      // A newly compiled graph is not yet visible to other evaluations
+      graph->tryClaim();
+      claim.reset(*graph);
+
+      if (configurationManager.codeCachingEnabled())
+        graphCache.insert(hash, graph);
     }
     
     graph->execute(parameterHolder);
@@ -140,9 +263,6 @@ public:
   }
 };
 
-template<typename T_element>
-TGCache<T_element> TGEvaluator<T_element>::graphCache;
-
 }
 
 }
@@ -33,6 +33,7 @@
 #include <boost/scoped_ptr.hpp>
 #include <boost/bind.hpp>
 #include <boost/ref.hpp>
+#include <boost/atomic.hpp>
 #include <sys/time.h>
 
 namespace desola
@@ -48,10 +49,15 @@ private:
   TGExpressionGraph(const TGExpressionGraph&);
   TGExpressionGraph& operator=(const TGExpressionGraph&);
   
+  Context& context;
   std::vector<TGExpressionNode<T_element>*> exprVector;
   boost::scoped_ptr<tg::tuTaskGraph> taskGraphObject;
   NameGenerator generator;
 
+  // Parameters are bound on the TaskGraph object itself, so a compiled graph
+  // can only be executed by one evaluation at a time.
+  boost::atomic<bool> claimed;
+
   mutable bool isHashCached;
   mutable std::size_t cachedHash;
   
@@ -72,28 +78,53 @@ private:
     }
   };
 
+  // A depth-first postorder from the leaves, kept iterative since fused graphs can be deep
   std::vector<TGExpressionNode<T_element>*> getTopologicalSort() const
   {
+    typedef typename TGExpressionNode<T_element>::dependency_const_iterator DependencyIterator;
+    typedef std::pair<TGExpressionNode<T_element>*, DependencyIterator> Frame;
+
     const std::vector<TGExpressionNode<T_element>*> leaves(getLeaves(exprVector));
     std::vector<TGExpressionNode<T_element>*> nodes;
-    std::set<TGExpressionNode<T_element>*> visited; 
+    std::vector<Frame> stack;
     nodes.reserve(exprVector.size());
 
-    typedef std::back_insert_iterator< std::vector<TGExpressionNode<T_element>*> > OutputIterator;
-    OutputIterator out(nodes);
-    std::for_each(leaves.begin(), leaves.end(), boost::bind(getTopologicalSortHelper<OutputIterator>, _1, boost::ref(visited), boost::ref(out)));
-    return nodes;
-  }
+    BOOST_FOREACH(TGExpressionNode<T_element>* node, exprVector)
+    {
+      node->setMarked(false);
+    }
 
-  template<typename OutputIterator>
-  static void getTopologicalSortHelper(TGExpressionNode<T_element>* const node, std::set<TGExpressionNode<T_element>*>& visited, OutputIterator& out)
-  {
-    if (visited.insert(node).second)
+    BOOST_FOREACH(TGExpressionNode<T_element>* leaf, leaves)
     {
-      std::for_each(node->beginDependencies(), node->endDependencies(), 
-        boost::bind(getTopologicalSortHelper<OutputIterator>, _1, boost::ref(visited), boost::ref(out)));
-      *out++ = node;
+      if (leaf->isMarked())
+        continue;
+
+      leaf->setMarked(true);
+      stack.push_back(Frame(leaf, leaf->beginDependencies()));
+
+      while(!stack.empty())
+      {
+        Frame& frame(stack.back());
+
+        if (frame.second == frame.first->endDependencies())
+        {
+          nodes.push_back(frame.first);
+          stack.pop_back();
+        }
+        else
+        {
+          TGExpressionNode<T_element>* const dependency = *frame.second++;
+
+          if (!dependency->isMarked())
+          {
+            dependency->setMarked(true);
+            stack.push_back(Frame(dependency, dependency->beginDependencies()));
+          }
+        }
+      }
     }
+
+    return nodes;
   }
 
   static std::vector<TGExpressionNode<T_element>*> getLeaves(const std::vector<TGExpressionNode<T_element>*>& nodes)
@@ -121,8 +152,13 @@ private:
   }
 
 public:
-  TGExpressionGraph() : taskGraphObject(NULL), isHashCached(false)
+  TGExpressionGraph(Context& c) : context(c), taskGraphObject(NULL), claimed(false), isHashCached(false)
+  {
+  }
+
+  inline Context& getContext()
   {
+    return context;
   }
 
   inline void add(TGExpressionNode<T_element>* const value)
@@ -167,7 +203,7 @@ public:
 
   tg::Compilers getTaskCompiler() const
   {
-    const ConfigurationManager& configurationManager(ConfigurationManager::getConfigurationManager());
+    const ConfigurationManager& configurationManager(context.getConfigurationManager());
     
     if (configurationManager.usingGCC())
     {
@@ -190,7 +226,7 @@ public:
     gettimeofday(&time, NULL);
     const double startTime = time.tv_sec + time.tv_usec/1000000.0;
     
-    const ConfigurationManager& configurationManager(ConfigurationManager::getConfigurationManager());
+    const ConfigurationManager& configurationManager(context.getConfigurationManager());
 
     if (configurationManager.loopFusionEnabled())
     {
@@ -209,7 +245,7 @@ public:
 
     gettimeofday(&time, NULL);
     const double duration = (time.tv_sec + time.tv_usec/1000000.0) - startTime;
-    StatisticsCollector& statsCollector = StatisticsCollector::getStatisticsCollector();
+    StatisticsCollector& statsCollector = context.getStatisticsCollector();
     statsCollector.addCompileTime(duration);
     statsCollector.incrementCompileCount();
   }
@@ -219,6 +255,17 @@ public:
     const_cast<tg::tuTaskGraph&>(*taskGraphObject).print();
   }
 
+  inline bool tryClaim()
+  {
+    bool expected = false;
+    return claimed.compare_exchange_strong(expected, true, boost::memory_order_acquire);
+  }
+
+  inline void release()
+  {
+    claimed.store(false, boost::memory_order_release);
+  }
+
   void execute(const ParameterHolder& parameterHolder)
   {
     parameterHolder.setParameters(*taskGraphObject);
@@ -28,6 +28,7 @@
 #include <boost/type_traits/add_const.hpp>  
 #include <boost/variant.hpp>
 #include <boost/foreach.hpp>
+#include <desola/NodePool.hpp>
 #include <desola/tg/Desola_tg_fwd.hpp>
 
 namespace desola
@@ -225,6 +226,9 @@ private:
   std::vector<TGExpressionNode<T_element>*> dependencies;
   std::vector<TGExpressionNode<T_element>*> reverseDependencies;
 
+  // Scratch flag for traversals of the owning graph
+  bool marked;
+
   struct InternalTypeComparator : public boost::static_visitor<bool>
   {
     template<typename T>
@@ -303,13 +307,34 @@ protected:
   virtual void alterDependencyImpl(const TGOutputReference<tg_matrix, T_element>& previous, TGOutputReference<tg_matrix, T_element>& next) = 0;
 
 public:
+  // Mirrors are rebuilt for every evaluation, so they share the pool used for expression nodes
+  static void* operator new(const std::size_t size)
+  {
+    return NodePool::allocate(size);
+  }
+
+  static void operator delete(void* const p, const std::size_t size)
+  {
+    NodePool::deallocate(p, size);
+  }
+
   typedef typename std::vector<TGExpressionNode<T_element>*>::const_iterator dependency_const_iterator;
   typedef typename std::vector<TGExpressionNode<T_element>*>::const_iterator rev_dependency_const_iterator;
   typedef typename boost::make_variant_over<internal_types>::type internal_variant_type;
   typedef typename boost::make_variant_over<internal_types_const>::type const_internal_variant_type;
 
-  TGExpressionNode()
+  TGExpressionNode() : marked(false)
+  {
+  }
+
+  bool isMarked() const
+  {
+    return marked;
+  }
+
+  void setMarked(const bool m)
   {
+    marked = m;
   }
 
   dependency_const_iterator beginDependencies() const
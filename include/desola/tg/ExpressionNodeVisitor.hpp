@@ -36,6 +36,9 @@ public:
   virtual void visit(TGElementSet<tg_vector, T_element>& e) = 0;
   virtual void visit(TGElementSet<tg_matrix, T_element>& e) = 0;
 
+  virtual void visit(TGSlice<tg_vector, T_element>& e) = 0;
+  virtual void visit(TGSlice<tg_matrix, T_element>& e) = 0;
+
   virtual void visit(TGLiteral<tg_scalar, T_element>& e)=0;
   virtual void visit(TGLiteral<tg_vector, T_element>& e)=0;
   virtual void visit(TGLiteral<tg_matrix, T_element>& e)=0;
@@ -46,6 +49,7 @@ public:
   virtual void visit(TGVectorDot<T_element>& e)=0;
   virtual void visit(TGVectorCross<T_element>& e)=0;
   virtual void visit(TGVectorTwoNorm<T_element>& e)=0;
+  virtual void visit(TGVectorAxpby<T_element>& e)=0;
   virtual void visit(TGMatrixTranspose<T_element>& e)=0;
 
   virtual void visit(TGPairwise<tg_scalar, T_element>& e) = 0;
@@ -107,6 +107,15 @@ private:
     return seed;
   }
 
+  template<typename exprType>
+  std::size_t hashSlice(const TGSlice<exprType, T_element>& node) const
+  {
+    std::size_t seed = hashUnOp(node);
+    boost::hash_combine(seed, node.getOffset());
+    boost::hash_combine(seed, node.getStride());
+    return seed;
+  }
+
   template<typename exprType>
   std::size_t hashSingleElementSet(const std::pair<const TGElementIndex<exprType>, const TGOutputReference<tg_scalar, T_element> >& pair) const
   {
@@ -176,6 +185,16 @@ public:
     boost::hash_combine(hash, hashElementSet(e));
   }
 
+  virtual void visit(TGSlice<tg_vector, T_element>& e)
+  {
+    boost::hash_combine(hash, hashSlice(e));
+  }
+  
+  virtual void visit(TGSlice<tg_matrix, T_element>& e)
+  {
+    boost::hash_combine(hash, hashSlice(e));
+  }
+
   virtual void visit(TGLiteral<tg_scalar, T_element>& e)
   {
     boost::hash_combine(hash, hashExprNode(e));
@@ -231,6 +250,16 @@ public:
   {
     boost::hash_combine(hash, hashUnOp(e));
   }
+
+  virtual void visit(TGVectorAxpby<T_element>& e)
+  {
+    boost::hash_combine(hash, hashExprNode(e));
+    boost::hash_combine(hash, e.getOperation());
+    boost::hash_combine(hash, hashOutputReference(e.getX()));
+    boost::hash_combine(hash, hashOutputReference(e.getAlpha()));
+    boost::hash_combine(hash, hashOutputReference(e.getY()));
+    boost::hash_combine(hash, hashOutputReference(e.getBeta()));
+  }
   
   virtual void visit(TGMatrixTranspose<T_element>& e)
   {
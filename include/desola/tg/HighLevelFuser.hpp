@@ -40,6 +40,9 @@ public:
   void visit(TGElementSet<tg_vector, T_element>& e) {}
   void visit(TGElementSet<tg_matrix, T_element>& e) {}
 
+  void visit(TGSlice<tg_vector, T_element>& e) {}
+  void visit(TGSlice<tg_matrix, T_element>& e) {}
+
   void visit(TGLiteral<tg_scalar, T_element>& e) {}
   void visit(TGLiteral<tg_vector, T_element>& e) {}
   void visit(TGLiteral<tg_matrix, T_element>& e) {}
@@ -57,6 +60,7 @@ public:
   void visit(TGVectorDot<T_element>& e) {}
   void visit(TGVectorCross<T_element>& e) {}
   void visit(TGVectorTwoNorm<T_element>& e) {}
+  void visit(TGVectorAxpby<T_element>& e) {}
   void visit(TGMatrixTranspose<T_element>& e) {}
 
   void visit(TGPairwise<tg_scalar, T_element>& e) {}
@@ -102,18 +106,21 @@ private:
   static std::set<TGExpressionNode<T_element>*> getDependencies(TGExpressionNode<T_element>* const node)
   {
     std::set<TGExpressionNode<T_element>*> dependencies;
-    getDependenciesHelper(dependencies, node);
-    return dependencies;
-  }
+    std::vector<TGExpressionNode<T_element>*> stack(1, node);
 
-  static void getDependenciesHelper(std::set<TGExpressionNode<T_element>*>& dependencies,
-    TGExpressionNode<T_element>* const node)
-  {
-    BOOST_FOREACH(TGExpressionNode<T_element>* dependency, std::make_pair(node->beginDependencies(), node->endDependencies()))
+    while(!stack.empty())
     {
-      if (dependencies.insert(dependency).second)
-        getDependenciesHelper(dependencies, dependency);
+      TGExpressionNode<T_element>* const current = stack.back();
+      stack.pop_back();
+
+      BOOST_FOREACH(TGExpressionNode<T_element>* dependency, std::make_pair(current->beginDependencies(), current->endDependencies()))
+      {
+        if (dependencies.insert(dependency).second)
+          stack.push_back(dependency);
+      }
     }
+
+    return dependencies;
   }
 
   void attemptFusion(const TGOutputReference<tg_matrix, T_element>& matrix, const std::vector<TGMatrixVectorMult<T_element>*>& matVecMuls)
@@ -302,6 +302,85 @@ public:
   }
 };
 
+template<typename T_element>
+class TGVectorAxpby : public TGExprNode<tg_vector, T_element>
+{
+private:
+  const TGPairwiseOp op;
+  TGOutputReference<tg_vector, T_element> x;
+  TGOutputReference<tg_scalar, T_element> alpha;
+  TGOutputReference<tg_vector, T_element> y;
+  TGOutputReference<tg_scalar, T_element> beta;
+
+public:
+  bool isEqual(const TGVectorAxpby& node, const std::map<const TGExpressionNode<T_element>*, const TGExpressionNode<T_element>*>& mappings) const
+  {
+    return TGExprNode<tg_vector, T_element>::isEqual(node, mappings) &&
+           op == node.op &&
+           TGExpressionNode<T_element>::isEqual(x, node.x, mappings) &&
+           TGExpressionNode<T_element>::isEqual(alpha, node.alpha, mappings) &&
+           TGExpressionNode<T_element>::isEqual(y, node.y, mappings) &&
+           TGExpressionNode<T_element>::isEqual(beta, node.beta, mappings);
+  }
+
+  TGVectorAxpby(TGVector<T_element>* internal, const TGPairwiseOp o,
+    const TGOutputReference<tg_vector, T_element>& _x, const TGOutputReference<tg_scalar, T_element>& _alpha,
+    const TGOutputReference<tg_vector, T_element>& _y, const TGOutputReference<tg_scalar, T_element>& _beta) : 
+    TGExprNode<tg_vector, T_element>(internal), op(o), x(_x), alpha(_alpha), y(_y), beta(_beta)
+  {
+    this->registerDependency(x.getExpressionNode());
+    this->registerDependency(alpha.getExpressionNode());
+    this->registerDependency(y.getExpressionNode());
+    this->registerDependency(beta.getExpressionNode());
+  }
+
+  const TGPairwiseOp getOperation() const
+  {
+    return op;
+  }
+
+  inline TGOutputReference<tg_vector, T_element> getX() const
+  {
+    return x;
+  }
+
+  inline TGOutputReference<tg_scalar, T_element> getAlpha() const
+  {
+    return alpha;
+  }
+
+  inline TGOutputReference<tg_vector, T_element> getY() const
+  {
+    return y;
+  }
+
+  inline TGOutputReference<tg_scalar, T_element> getBeta() const
+  {
+    return beta;
+  }
+
+  void accept(TGExpressionNodeVisitor<T_element>& v)
+  {
+    v.visit(*this);
+  }
+
+  virtual void alterDependencyImpl(const TGOutputReference<tg_scalar, T_element>& previous, TGOutputReference<tg_scalar, T_element>& next)
+  {
+    ReplaceOutputReference<tg_scalar, tg_scalar, T_element>()(alpha, previous, next);
+    ReplaceOutputReference<tg_scalar, tg_scalar, T_element>()(beta, previous, next);
+  }
+
+  virtual void alterDependencyImpl(const TGOutputReference<tg_vector, T_element>& previous, TGOutputReference<tg_vector, T_element>& next)
+  {
+    ReplaceOutputReference<tg_vector, tg_vector, T_element>()(x, previous, next);
+    ReplaceOutputReference<tg_vector, tg_vector, T_element>()(y, previous, next);
+  }
+
+  virtual void alterDependencyImpl(const TGOutputReference<tg_matrix, T_element>& previous, TGOutputReference<tg_matrix, T_element>& next)
+  {
+  }
+};
+
 }
 
 }
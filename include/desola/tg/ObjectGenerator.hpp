@@ -128,6 +128,34 @@ public:
     matrixHandler.handleNode(e, new TGElementSet<tg_matrix, T_element>(internal, v, tgAssignments));
   }
     
+  void visit(Slice<vector, T_element>& e)
+  {
+    TGOutputReference<tg_vector, T_element> v = vectorHandler.getTGExprNode(e.getOperand());
+
+    // As with transposes, a slice only consumed inside the generated code is a view of its operand
+    TGVector<T_element>* internal;
+    if (vectorHandler.mustSaveResult(e))
+      internal = vectorHandler.createTGRep(e);
+    else
+      internal = new TGSlicedVector<T_element>(v.getInternal(), e.getRowCount(), e.getOffset().getRow(), e.getStride().getRow());
+
+    vectorHandler.handleNode(e, new TGSlice<tg_vector, T_element>(internal, v, e.getOffset(), e.getStride()));
+  }
+
+  void visit(Slice<matrix, T_element>& e)
+  {
+    TGOutputReference<tg_matrix, T_element> m = matrixHandler.getTGExprNode(e.getOperand());
+
+    TGMatrix<T_element>* internal;
+    if (matrixHandler.mustSaveResult(e))
+      internal = matrixHandler.createTGRep(e);
+    else
+      internal = new TGSlicedMatrix<T_element>(m.getInternal(), e.getRowCount(), e.getColCount(), 
+        e.getOffset().getRow(), e.getOffset().getCol(), e.getStride().getRow(), e.getStride().getCol());
+
+    matrixHandler.handleNode(e, new TGSlice<tg_matrix, T_element>(internal, m, e.getOffset(), e.getStride()));
+  }
+
   void visit(Literal<scalar, T_element>& e)
   {
     assert(false);
@@ -190,10 +218,28 @@ public:
     scalarHandler.handleNode(e, new TGVectorTwoNorm<T_element>(internal, v));
   }
   
+  void visit(VectorAxpby<T_element>& e)
+  {
+    TGPairwiseOp op = getTGPairwiseOp(e.getOperation());
+    TGVector<T_element>* internal = vectorHandler.createTGRep(e);
+    TGOutputReference<tg_vector, T_element> x = vectorHandler.getTGExprNode(e.getX());
+    TGOutputReference<tg_scalar, T_element> alpha = scalarHandler.getTGExprNode(e.getAlpha());
+    TGOutputReference<tg_vector, T_element> y = vectorHandler.getTGExprNode(e.getY());
+    TGOutputReference<tg_scalar, T_element> beta = scalarHandler.getTGExprNode(e.getBeta());
+    vectorHandler.handleNode(e, new TGVectorAxpby<T_element>(internal, op, x, alpha, y, beta));
+  }
+  
   void visit(MatrixTranspose<T_element>& e)
   {
-    TGMatrix<T_element>* internal = matrixHandler.createTGRep(e);
     TGOutputReference<tg_matrix, T_element> m = matrixHandler.getTGExprNode(e.getOperand());
+
+    // A transpose that is only consumed inside the generated code is a view of its operand
+    TGMatrix<T_element>* internal;
+    if (matrixHandler.mustSaveResult(e))
+      internal = matrixHandler.createTGRep(e);
+    else
+      internal = new TGTransposedMatrix<T_element>(m.getInternal());
+
     matrixHandler.handleNode(e, new TGMatrixTranspose<T_element>(internal, m));
   }
 
@@ -92,7 +92,7 @@ public:
     {
       Literal<exprType, T_element>* const literal = getStrategy().getEvaluatedExpr(&e);
       const bool hasData = getStrategy().hasData(literal);
-      typename ExprTGTraits<exprType, T_element>::internalRepCreator creator(getGraph().getNameGenerator(), hasData);
+      typename ExprTGTraits<exprType, T_element>::internalRepCreator creator(getGraph().getNameGenerator(), getGraph().getContext().getConfigurationManager(), hasData);
       literal->getValue().accept(creator);
       tgInternalRepType* const tgInternalRep = creator.getResult();
       handleNode(e, new TGLiteral<tgExprType, T_element>(tgInternalRep));
@@ -104,12 +104,18 @@ public:
     }
   }
 
+  // Returns whether the value of an ExprNode must be stored for use outside the generated code
+  bool mustSaveResult(ExprNode<exprType, T_element>& e)
+  {
+    return getStrategy().mustEvaluate(evaluator, e) || e.getEvaluationDirective()==EVALUATE;
+  }
+
   // Creates the TGScalar/TGVector/TGMatrix storage representation for an
   // ExprNode, and maps this to a new Literal with the same storage 
   // representation if necessary.
   typename ExprTGTraits<exprType, T_element>::internalRep* createTGRep(ExprNode<exprType, T_element>& e) 
   {
-    const bool saveResult = getStrategy().mustEvaluate(evaluator, e) || e.getEvaluationDirective()==EVALUATE;
+    const bool saveResult = mustSaveResult(e);
     tgInternalRepType* const tgInternalRep = createTGInternalRep(saveResult, e);
     if (saveResult)
     {
@@ -30,6 +30,8 @@
 #include <TaskGraph>
 #include <boost/functional/hash.hpp>
 #include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
 #include "Desola_tg_fwd.hpp"
 #include "TaskGraphWrappers.hpp"
 
@@ -546,6 +548,8 @@ private:
   const std::size_t nnz;
   const std::size_t rows;
   const std::size_t cols;
+  const bool singleForLoop;
+  const bool specialise;
   TaskArrayWrapper<int, 1> col_ind;
   TaskArrayWrapper<int, 1> row_ptr;
   TaskArrayWrapper<T_element, 1> val;
@@ -608,10 +612,12 @@ private:
   }
 
 public:
-  TGCRSMatrix(NameGenerator& generator, CRSMatrix<T_element>& internal, const bool hasData) : 
+  TGCRSMatrix(NameGenerator& generator, const ConfigurationManager& configurationManager, CRSMatrix<T_element>& internal, const bool hasData) : 
     parameter(true), col_ind_name(generator.getName(getColIndPrefix())), row_ptr_name(generator.getName(getRowPtrPrefix())), 
-    val_name(generator.getName(getValPrefix())), nnz(internal.nnz()), rows(internal.getRowCount()), 
-    cols(internal.getColCount()), col_ind(true, col_ind_name, nnz), row_ptr(true, row_ptr_name, internal.row_ptr_size()),
+    val_name(generator.getName(getValPrefix())), nnz(internal.nnz()), rows(internal.getRowCount()), cols(internal.getColCount()), 
+    singleForLoop(configurationManager.singleForLoopSparseIterationEnabled()),
+    specialise(configurationManager.sparseSpecialisationEnabled()),
+    col_ind(true, col_ind_name, nnz), row_ptr(true, row_ptr_name, internal.row_ptr_size()),
     val(true, val_name, nnz), possibleData(hasData ? &internal : NULL)
   {
   }
@@ -687,9 +693,8 @@ public:
   virtual void iterateSparse(NameGenerator& generator, MatrixIterationCallback& callback) const
   {
     using namespace tg;
-    const ConfigurationManager& configurationManager(ConfigurationManager::getConfigurationManager());
 
-    if (configurationManager.singleForLoopSparseIterationEnabled())
+    if (singleForLoop)
     {
       tVarNamed(unsigned, valPtr, generator.getName("valPtr").c_str());
       tVarNamed(unsigned, currentRow, generator.getName("currentRow").c_str());
@@ -704,7 +709,7 @@ public:
         callback(generator, currentRow, (*col_ind)[valPtr], TGScalarExpr<T_element>((*val)[valPtr]));
       }
     }
-    else if (possibleData != NULL && configurationManager.sparseSpecialisationEnabled())
+    else if (possibleData != NULL && specialise)
     {
       specialisedIterateSparse(generator, callback);
     }
@@ -728,6 +733,27 @@ public:
     }
   }
 
+  // Visits the non-zeros of rows firstRow + i*rowStride for i < rowCount, passing i as the row
+  void iterateSparseRows(NameGenerator& generator, const std::size_t firstRow, const std::size_t rowCount, 
+                         const std::size_t rowStride, MatrixIterationCallback& callback) const
+  {
+    using namespace tg;
+
+    tVarNamed(unsigned, i, generator.getName("slicedRow").c_str());
+    tVarNamed(unsigned, row, generator.getName("row").c_str());
+    tVarNamed(unsigned, valPtr, generator.getName("valPtr").c_str());
+
+    tFor(i, 0u, rowCount-1)
+    {
+      row = i * rowStride + firstRow;
+
+      tFor(valPtr, (*row_ptr)[row], (*row_ptr)[row+1] - 1)
+      {
+        callback(generator, i, (*col_ind)[valPtr], TGScalarExpr<T_element>((*val)[valPtr]));
+      }
+    }
+  }
+
   virtual void addParameterMappings(InternalMatrix<T_element>& internal, ParameterHolder& params) const
   {
     assert(parameter);
@@ -800,17 +826,412 @@ public:
   };
 };
 
+// Presents the storage of another matrix with its rows and columns
+// exchanged. It owns no storage, so the transpose of an intermediate
+// costs nothing and consumers index the original matrix directly.
+template<typename T_element>
+class TGTransposedMatrix : public TGMatrix<T_element>
+{
+public:
+  typedef typename TGMatrix<T_element>::MatrixIterationCallback MatrixIterationCallback;
+
+private:
+  TGMatrix<T_element>& matrix;
+
+  static void exchangeIndices(MatrixIterationCallback& callback, NameGenerator& generator, const tg::TaskExpression& row, const tg::TaskExpression& col, const TGScalarExpr<T_element>& value)
+  {
+    callback(generator, col, row, value);
+  }
+
+public:
+  TGTransposedMatrix(TGMatrix<T_element>& m) : matrix(m)
+  {
+  }
+
+  const TGScalarExpr<T_element> getExpression(NameGenerator& generator, const tg::TaskExpression& row, const tg::TaskExpression& col) const
+  {
+    return matrix.getExpression(generator, col, row);
+  }
+
+  void setExpression(NameGenerator& generator, const tg::TaskExpression& row, const tg::TaskExpression& col, const TGScalarExpr<T_element>& e)
+  {
+    matrix.setExpression(generator, col, row, e);
+  }
+
+  void addExpression(NameGenerator& generator, const tg::TaskExpression& row, const tg::TaskExpression& col, const TGScalarExpr<T_element>& e)
+  {
+    matrix.addExpression(generator, col, row, e);
+  }
+  
+  virtual std::size_t getRows() const
+  {
+    return matrix.getCols();
+  }
+
+  virtual std::size_t getCols() const
+  {
+    return matrix.getRows();
+  }
+
+  virtual void iterateDense(NameGenerator& generator, MatrixIterationCallback& callback) const
+  {
+    MatrixIterationCallback exchanged = boost::bind(exchangeIndices, boost::ref(callback), _1, _2, _3, _4);
+    matrix.iterateDense(generator, exchanged);
+  }
+
+  virtual void iterateSparse(NameGenerator& generator, MatrixIterationCallback& callback) const
+  {
+    MatrixIterationCallback exchanged = boost::bind(exchangeIndices, boost::ref(callback), _1, _2, _3, _4);
+    matrix.iterateSparse(generator, exchanged);
+  }
+
+  virtual InternalMatrix<T_element>* createInternalRep() const
+  {
+    //FIXME: Handle this problem better
+    assert(0 && "A transposed view of a matrix has no storage of its own.");
+    return NULL;
+  }
+
+  virtual bool isParameter() const
+  {
+    return false;
+  }
+
+  virtual void addParameterMappings(InternalMatrix<T_element>& internal, ParameterHolder& params) const
+  {
+    assert(0 && "A transposed view of a matrix has no parameters.");
+  }
+
+  virtual std::size_t hashValue() const
+  {
+    const char* nodeTypeString = typeid(*this).name();
+    std::size_t seed = boost::hash_range(nodeTypeString, nodeTypeString+strlen(nodeTypeString));
+    boost::hash_combine(seed, matrix.hashValue());
+    return seed;
+  }
+
+  virtual bool matches(const TGMatrix<T_element>& m) const
+  {
+    if (typeid(m) == typeid(*this))
+    {
+      const TGTransposedMatrix& right = static_cast<const TGTransposedMatrix&>(m);
+      return matrix.matches(right.matrix);
+    }
+    else
+    {
+      return false;
+    }
+  }
+   
+  virtual void createTaskGraphVariable()
+  {
+  }
+};
+
+
+// Presents every stride-th element of another vector starting at an offset.
+// Like TGTransposedMatrix it owns no storage.
+template<typename T_element>
+class TGSlicedVector : public TGVector<T_element>
+{
+private:
+  TGVector<T_element>& vector;
+  const std::size_t rows;
+  const std::size_t offset;
+  const std::size_t stride;
+
+  const tg::TaskExpression getSourceRow(const tg::TaskExpression& row) const
+  {
+    return row * stride + offset;
+  }
+
+public:
+  TGSlicedVector(TGVector<T_element>& v, const std::size_t r, const std::size_t o, const std::size_t s) : 
+    vector(v), rows(r), offset(o), stride(s)
+  {
+  }
+
+  const TGScalarExpr<T_element> getExpression(const tg::TaskExpression& row) const
+  {
+    return vector.getExpression(getSourceRow(row));
+  }
+
+  void setExpression(const tg::TaskExpression& row, const TGScalarExpr<T_element>& e)
+  {
+    vector.setExpression(getSourceRow(row), e);
+  }
+
+  void addExpression(const tg::TaskExpression& row, const TGScalarExpr<T_element>& e)
+  {
+    vector.addExpression(getSourceRow(row), e);
+  }
+
+  virtual std::size_t getRows() const
+  {
+    return rows;
+  }
+
+  virtual InternalVector<T_element>* createInternalRep() const
+  {
+    //FIXME: Handle this problem better
+    assert(0 && "A slice of a vector has no storage of its own.");
+    return NULL;
+  }
+
+  virtual bool isParameter() const
+  {
+    return false;
+  }
+
+  virtual void addParameterMappings(InternalVector<T_element>& internal, ParameterHolder& params) const
+  {
+    assert(0 && "A slice of a vector has no parameters.");
+  }
+  
+  virtual std::size_t hashValue() const
+  {
+    const char* nodeTypeString = typeid(*this).name();
+    std::size_t seed = boost::hash_range(nodeTypeString, nodeTypeString+strlen(nodeTypeString));
+    boost::hash_combine(seed, vector.hashValue());
+    boost::hash_combine(seed, rows);
+    boost::hash_combine(seed, offset);
+    boost::hash_combine(seed, stride);
+    return seed;
+  }
+
+  virtual bool matches(const TGVector<T_element>& v) const
+  {
+    if (typeid(v) == typeid(*this))
+    {
+      const TGSlicedVector& right = static_cast<const TGSlicedVector&>(v);
+      return vector.matches(right.vector) &&
+             rows == right.rows &&
+             offset == right.offset &&
+             stride == right.stride;
+    }
+    else
+    {
+      return false;
+    }
+  }
+    
+  virtual void createTaskGraphVariable()
+  {
+  }
+};
+
+// Presents a strided block of another matrix. Sparse iteration over a block
+// of a CRS matrix only visits the non-zeros of the block's rows, and filters
+// them by column.
+template<typename T_element>
+class TGSlicedMatrix : public TGMatrix<T_element>
+{
+public:
+  typedef typename TGMatrix<T_element>::MatrixIterationCallback MatrixIterationCallback;
+
+private:
+  TGMatrix<T_element>& matrix;
+  const std::size_t rows;
+  const std::size_t cols;
+  const std::size_t rowOffset;
+  const std::size_t colOffset;
+  const std::size_t rowStride;
+  const std::size_t colStride;
+
+  static void filterColumn(const TGSlicedMatrix& slice, MatrixIterationCallback& callback, NameGenerator& generator, 
+                           const tg::TaskExpression& row, const tg::TaskExpression& col, const TGScalarExpr<T_element>& value)
+  {
+    using namespace tg;
+
+    tIf(col >= slice.colOffset)
+    {
+      tIf(col <= slice.colOffset + (slice.cols-1) * slice.colStride)
+      {
+        if (slice.colStride == 1)
+        {
+          callback(generator, row, col - slice.colOffset, value);
+        }
+        else
+        {
+          tIf((col - slice.colOffset) % slice.colStride == 0u)
+          {
+            callback(generator, row, (col - slice.colOffset) / slice.colStride, value);
+          }
+        }
+      }
+    }
+  }
+
+  static void filterElement(const TGSlicedMatrix& slice, MatrixIterationCallback& callback, NameGenerator& generator, 
+                            const tg::TaskExpression& row, const tg::TaskExpression& col, const TGScalarExpr<T_element>& value)
+  {
+    using namespace tg;
+
+    tIf(row >= slice.rowOffset)
+    {
+      tIf(row <= slice.rowOffset + (slice.rows-1) * slice.rowStride)
+      {
+        tIf(col >= slice.colOffset)
+        {
+          tIf(col <= slice.colOffset + (slice.cols-1) * slice.colStride)
+          {
+            // The stride tests are only generated where a stride skips elements
+            if (slice.rowStride == 1 && slice.colStride == 1)
+            {
+              callback(generator, row - slice.rowOffset, col - slice.colOffset, value);
+            }
+            else
+            {
+              tIf((row - slice.rowOffset) % slice.rowStride == 0u)
+              {
+                tIf((col - slice.colOffset) % slice.colStride == 0u)
+                {
+                  callback(generator, (row - slice.rowOffset) / slice.rowStride, (col - slice.colOffset) / slice.colStride, value);
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+public:
+  TGSlicedMatrix(TGMatrix<T_element>& m, const std::size_t r, const std::size_t c, 
+                 const std::size_t ro, const std::size_t co, const std::size_t rs, const std::size_t cs) : 
+    matrix(m), rows(r), cols(c), rowOffset(ro), colOffset(co), rowStride(rs), colStride(cs)
+  {
+  }
+
+  const TGScalarExpr<T_element> getExpression(NameGenerator& generator, const tg::TaskExpression& row, const tg::TaskExpression& col) const
+  {
+    return matrix.getExpression(generator, row * rowStride + rowOffset, col * colStride + colOffset);
+  }
+
+  void setExpression(NameGenerator& generator, const tg::TaskExpression& row, const tg::TaskExpression& col, const TGScalarExpr<T_element>& e)
+  {
+    matrix.setExpression(generator, row * rowStride + rowOffset, col * colStride + colOffset, e);
+  }
+
+  void addExpression(NameGenerator& generator, const tg::TaskExpression& row, const tg::TaskExpression& col, const TGScalarExpr<T_element>& e)
+  {
+    matrix.addExpression(generator, row * rowStride + rowOffset, col * colStride + colOffset, e);
+  }
+  
+  virtual std::size_t getRows() const
+  {
+    return rows;
+  }
+
+  virtual std::size_t getCols() const
+  {
+    return cols;
+  }
+
+  virtual void iterateDense(NameGenerator& generator, MatrixIterationCallback& callback) const
+  {
+    using namespace tg;
+
+    tVarNamed(unsigned, i, generator.getName("SlicedMatrix_row").c_str());
+    tVarNamed(unsigned, j, generator.getName("SlicedMatrix_col").c_str());
+
+    tFor(i, 0u, rows-1)
+    {
+      tFor(j, 0u, cols-1)
+      {
+        callback(generator, i, j, getExpression(generator, i, j));
+      }
+    }
+  }
+
+  // Dense storage is indexed directly. Other operands are views such as transposes, and indexing
+  // a view of a CRS matrix element by element would search a row for every element, so the
+  // view's own sparse iteration is filtered instead.
+  virtual void iterateSparse(NameGenerator& generator, MatrixIterationCallback& callback) const
+  {
+    if (typeid(matrix) == typeid(TGCRSMatrix<T_element>))
+    {
+      MatrixIterationCallback filtered = boost::bind(filterColumn, boost::cref(*this), boost::ref(callback), _1, _2, _3, _4);
+      static_cast<const TGCRSMatrix<T_element>&>(matrix).iterateSparseRows(generator, rowOffset, rows, rowStride, filtered);
+    }
+    else if (typeid(matrix) == typeid(TGConventionalMatrix<T_element>))
+    {
+      iterateDense(generator, callback);
+    }
+    else
+    {
+      MatrixIterationCallback filtered = boost::bind(filterElement, boost::cref(*this), boost::ref(callback), _1, _2, _3, _4);
+      matrix.iterateSparse(generator, filtered);
+    }
+  }
+
+  virtual InternalMatrix<T_element>* createInternalRep() const
+  {
+    //FIXME: Handle this problem better
+    assert(0 && "A slice of a matrix has no storage of its own.");
+    return NULL;
+  }
+
+  virtual bool isParameter() const
+  {
+    return false;
+  }
+
+  virtual void addParameterMappings(InternalMatrix<T_element>& internal, ParameterHolder& params) const
+  {
+    assert(0 && "A slice of a matrix has no parameters.");
+  }
+
+  virtual std::size_t hashValue() const
+  {
+    const char* nodeTypeString = typeid(*this).name();
+    std::size_t seed = boost::hash_range(nodeTypeString, nodeTypeString+strlen(nodeTypeString));
+    boost::hash_combine(seed, matrix.hashValue());
+    boost::hash_combine(seed, rows);
+    boost::hash_combine(seed, cols);
+    boost::hash_combine(seed, rowOffset);
+    boost::hash_combine(seed, colOffset);
+    boost::hash_combine(seed, rowStride);
+    boost::hash_combine(seed, colStride);
+    return seed;
+  }
+
+  virtual bool matches(const TGMatrix<T_element>& m) const
+  {
+    if (typeid(m) == typeid(*this))
+    {
+      const TGSlicedMatrix& right = static_cast<const TGSlicedMatrix&>(m);
+      return matrix.matches(right.matrix) &&
+             rows == right.rows &&
+             cols == right.cols &&
+             rowOffset == right.rowOffset &&
+             colOffset == right.colOffset &&
+             rowStride == right.rowStride &&
+             colStride == right.colStride;
+    }
+    else
+    {
+      return false;
+    }
+  }
+   
+  virtual void createTaskGraphVariable()
+  {
+  }
+};
+
 
 template<typename T_element>
 class TGMatrixGen : public InternalMatrixVisitor<T_element>
 {
 private:
   NameGenerator& generator;
+  const ConfigurationManager& configurationManager;
   TGMatrix<T_element>* result;
   const bool hasData;
 
 public:
-  TGMatrixGen(NameGenerator& g, const bool _hasData) : generator(g), hasData(_hasData)
+  TGMatrixGen(NameGenerator& g, const ConfigurationManager& c, const bool _hasData) : generator(g), configurationManager(c), hasData(_hasData)
   {
   }
   
@@ -821,7 +1242,7 @@ public:
 
   void visit(CRSMatrix<T_element>& m)
   {
-    result = new TGCRSMatrix<T_element>(generator, m, hasData);
+    result = new TGCRSMatrix<T_element>(generator, configurationManager, m, hasData);
   }
 
   TGMatrix<T_element>* getResult() const
@@ -836,11 +1257,12 @@ class TGVectorGen : public InternalVectorVisitor<T_element>
 {
 private:
   NameGenerator& generator;
+  const ConfigurationManager& configurationManager;
   TGVector<T_element>* result;
   const bool hasData;
 
 public:
-  TGVectorGen(NameGenerator& g, const bool _hasData) : generator(g), hasData(_hasData)
+  TGVectorGen(NameGenerator& g, const ConfigurationManager& c, const bool _hasData) : generator(g), configurationManager(c), hasData(_hasData)
   {
   }
 
@@ -861,11 +1283,12 @@ class TGScalarGen : public InternalScalarVisitor<T_element>
 {
 private:
   NameGenerator& generator;
+  const ConfigurationManager& configurationManager;
   TGScalar<T_element>* result;
   const bool hasData;
 
 public:
-  TGScalarGen(NameGenerator& g, const bool _hasData) : generator(g), hasData(_hasData)
+  TGScalarGen(NameGenerator& g, const ConfigurationManager& c, const bool _hasData) : generator(g), configurationManager(c), hasData(_hasData)
   {
   }
 
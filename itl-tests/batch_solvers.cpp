@@ -0,0 +1,141 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+// Solves a batch of tridiagonal systems, one of which has a zero right hand
+// side, with each batched solver. Checks that every system converges and that
+// the solution of the zero system stays exactly zero.
+
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <iostream>
+#include <desola/Desola.hpp>
+#include <desola/itl_interface.hpp>
+
+namespace
+{
+
+typedef double Type;
+
+const std::size_t batchSize = 4;
+const std::size_t systemSize = 16;
+const std::size_t zeroSystem = 2;
+const int maxIterations = 100;
+const Type tolerance = 1e-10;
+
+// System i is tridiagonal with (i+2) on the diagonal and -1 either side
+class TridiagonalBatch
+{
+private:
+  std::vector<int> rowPtr;
+  std::vector<int> colInd;
+  std::vector<Type> values;
+  std::vector<Type> rhs;
+
+public:
+  TridiagonalBatch() : rhs(batchSize * systemSize)
+  {
+    for(std::size_t row = 0; row < systemSize; ++row)
+    {
+      rowPtr.push_back(colInd.size());
+
+      for(std::size_t col = (row == 0 ? 0 : row - 1); col <= row + 1 && col < systemSize; ++col)
+        colInd.push_back(col);
+    }
+
+    rowPtr.push_back(colInd.size());
+
+    for(std::size_t system = 0; system < batchSize; ++system)
+    {
+      for(std::size_t row = 0; row < systemSize; ++row)
+      {
+        for(int valPtr = rowPtr[row]; valPtr < rowPtr[row+1]; ++valPtr)
+          values.push_back(static_cast<std::size_t>(colInd[valPtr]) == row ? Type(system + 2) : Type(-1));
+
+        rhs[system * systemSize + row] = system == zeroSystem ? Type(0) : Type(row + 1);
+      }
+    }
+  }
+
+  desola::BatchMatrix<Type> getMatrix() const
+  {
+    return desola::BatchMatrix<Type>(batchSize, systemSize, &rowPtr[0], &colInd[0], &values[0]);
+  }
+
+  desola::BatchVector<Type> getRHS() const
+  {
+    return desola::BatchVector<Type>(batchSize, systemSize, &rhs[0]);
+  }
+
+  // Checks |b_i - A_i x_i| <= tol * |b_i| for every system, computed directly from the stored values
+  bool converged(const desola::BatchVector<Type>& x) const
+  {
+    const Type* const solution = x.getValues().begin();
+    const std::size_t nnz = rowPtr[systemSize];
+    bool result = true;
+
+    for(std::size_t system = 0; system < batchSize; ++system)
+    {
+      Type residualNorm = 0, rhsNorm = 0;
+
+      for(std::size_t row = 0; row < systemSize; ++row)
+      {
+        const std::size_t offset = system * systemSize;
+        Type residual = rhs[offset + row];
+
+        for(int valPtr = rowPtr[row]; valPtr < rowPtr[row+1]; ++valPtr)
+          residual -= values[system * nnz + valPtr] * solution[offset + colInd[valPtr]];
+
+        residualNorm += residual * residual;
+        rhsNorm += rhs[offset + row] * rhs[offset + row];
+      }
+
+      // NaNs fail both comparisons
+      const bool systemConverged = system == zeroSystem ? residualNorm == 0 : residualNorm <= tolerance * tolerance * rhsNorm;
+      result = result && systemConverged;
+    }
+
+    return result;
+  }
+};
+
+template<typename Solver>
+bool checkSolver(const char* const name, Solver solver)
+{
+  const TridiagonalBatch batch;
+  const desola::BatchMatrix<Type> A(batch.getMatrix());
+  const desola::BatchVector<Type> b(batch.getRHS());
+  desola::BatchVector<Type> x(batchSize, systemSize, Type(0));
+  int iterations = 0;
+
+  const int status = solver(A, x, b, maxIterations, tolerance, iterations);
+  const bool passed = status == 0 && batch.converged(x);
+
+  std::cout << name << ": Iterations: " << iterations << (passed ? "" : " FAILED") << std::endl;
+  return passed;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  bool passed = true;
+  passed = checkSolver("Batched CG", itl::batch_cg<Type>) && passed;
+  passed = checkSolver("Batched BiCGStab", itl::batch_bicgstab<Type>) && passed;
+
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,141 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+// Runs independent CG solves sharing one matrix on an increasing number of
+// application threads and reports the solve throughput at each thread count,
+// along with the number of graphs compiled while it was measured.
+// A final set of solves uses a right hand side computed on the main thread,
+// and checks the residual of each solution.
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include "library_specific.hpp"
+#include "statistics_generator.hpp"
+#include "itl/krylov/cg.h"
+
+using namespace itl;
+
+namespace
+{
+
+unsigned concurrentSolves;
+
+}
+
+template<typename MatrixType, typename VectorType, typename ScalarType>
+void independentSolve(const SolverOptions& options, MatrixType& A)
+{
+  VectorType x(num_cols(A), 0.0);
+  VectorType b(num_rows(A), 1.0);
+  identity_preconditioner precond;
+
+  basic_iteration<ScalarType> iter(b, options.getIterations(), 1e-9);
+  cg(A, x, b, precond(), iter);
+}
+
+// The right hand side is a value evaluated by another thread
+template<typename MatrixType, typename VectorType, typename ScalarType>
+void crossThreadSolve(const SolverOptions& options, MatrixType& A, const VectorType& b, double& relativeResidual)
+{
+  VectorType x(num_cols(A), 0.0);
+  identity_preconditioner precond;
+
+  basic_iteration<ScalarType> iter(b, options.getIterations(), 1e-9);
+  cg(A, x, b, precond(), iter);
+
+  VectorType r(num_rows(A), 0.0);
+  mult(A, scaled(x, -1.0), b, r);
+  relativeResidual = (two_norm(r) / two_norm(b)).value();
+}
+
+template<typename MatrixType, typename VectorType, typename ScalarType>
+void concurrentIndependentSolves(const SolverOptions& options, MatrixType& A, const unsigned threads)
+{
+  boost::thread_group group;
+
+  for(unsigned thread = 0; thread < threads; ++thread)
+    group.create_thread(boost::bind(&independentSolve<MatrixType, VectorType, ScalarType>, boost::cref(options), boost::ref(A)));
+
+  group.join_all();
+}
+
+template<typename MatrixType, typename VectorType, typename ScalarType>
+void solver(const SolverOptions& options, MatrixType& A, VectorType& x, VectorType& b)
+{
+  const desola::StatisticsCollector& statistics(desola::StatisticsCollector::getStatisticsCollector());
+
+  // A cached graph runs one evaluation at a time, so a solve that finds every
+  // instance busy compiles another. Running the largest number of concurrent
+  // solves first keeps those compilations, which are serialised, out of the timings.
+  concurrentIndependentSolves<MatrixType, VectorType, ScalarType>(options, A, concurrentSolves);
+
+  double baseline = 0.0;
+  std::cout.precision(5);
+  std::cout.setf(std::ios::fixed);
+
+  for(unsigned threads = 1; threads <= concurrentSolves; threads *= 2)
+  {
+    const int initialCompiles = statistics.getCompileCount();
+    const double startTime = StatisticsGenerator::getTime();
+
+    concurrentIndependentSolves<MatrixType, VectorType, ScalarType>(options, A, threads);
+
+    const double throughput = threads / (StatisticsGenerator::getTime() - startTime);
+
+    if (threads == 1)
+      baseline = throughput;
+
+    std::cout << "Concurrent Solves: " << threads << " Solves per Second: " << throughput 
+              << " Speedup: " << throughput / baseline << " Compilations: " << statistics.getCompileCount() - initialCompiles << std::endl;
+  }
+
+  // Evaluating the norm also evaluates the shared right hand side, so every thread reads a literal
+  VectorType sharedB(num_rows(A), 0.0);
+  mult(A, VectorType(num_cols(A), 1.0), sharedB);
+  std::cout << "Shared RHS Norm: " << two_norm(sharedB) << std::endl;
+
+  const unsigned threads = std::max(2u, concurrentSolves);
+  std::vector<double> residuals(threads, 0.0);
+  boost::thread_group group;
+
+  for(unsigned thread = 0; thread < threads; ++thread)
+    group.create_thread(boost::bind(&crossThreadSolve<MatrixType, VectorType, ScalarType>, boost::cref(options), boost::ref(A), 
+                                    boost::cref(sharedB), boost::ref(residuals[thread])));
+
+  group.join_all();
+
+  std::cout << "Cross-Thread Solves: " << threads << " Max Relative Residual: " 
+            << *std::max_element(residuals.begin(), residuals.end()) << std::endl;
+}
+
+int main (int argc, char* argv[])
+{
+  SolverOptions options("Symmetric Positive Definite matrix in Harwell-Boeing format");
+  options.addOptions()
+    ("concurrent-solves", po::value<unsigned>(&concurrentSolves)->default_value(4), "maximum number of independent solves to run concurrently");
+  options.processOptions(argc, argv);
+
+  library_init(options);
+  invokeSolver(options);
+
+  return EXIT_SUCCESS;
+}
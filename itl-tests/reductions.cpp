@@ -0,0 +1,92 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+// Computes dot products and two-norms of vectors whose sums depend on the
+// order of addition, for lengths on either side of multiples of the lane
+// count, and checks that the generated code gives results bit-identical to
+// the native blocked reductions.
+
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <iostream>
+#include <desola/Desola.hpp>
+
+namespace
+{
+
+typedef double Type;
+typedef desola::Vector<Type> Vector;
+
+const std::size_t sizes[] = {1, 7, 8, 9, 15, 16, 17, 63, 100, 1001};
+
+// Mixes large and small magnitudes of both signs so that any change in summation order changes the result
+std::vector<Type> createValues(const std::size_t size, const Type scale)
+{
+  std::vector<Type> values(size);
+
+  for(std::size_t i = 0; i < size; ++i)
+    values[i] = (i % 2 == 0 ? 1 : -1) * (i % 3 == 0 ? 1e8 : 1) * scale * (1 + i / 7.0);
+
+  return values;
+}
+
+Vector createVector(const std::vector<Type>& values)
+{
+  Vector v(values.size(), Type(0));
+
+  for(std::size_t i = 0; i < values.size(); ++i)
+    v(i) = values[i];
+
+  return v;
+}
+
+bool identical(const Type a, const Type b)
+{
+  return std::memcmp(&a, &b, sizeof(Type)) == 0;
+}
+
+bool checkSize(const std::size_t size)
+{
+  const std::vector<Type> xValues(createValues(size, 1.0)), yValues(createValues(size, 1.0/3.0));
+  const Vector x(createVector(xValues)), y(createVector(yValues));
+
+  const Type dot = x.dot(y).value();
+  const Type norm = x.two_norm().value();
+  const Type expectedDot = desola::detail::blockedDot(&xValues[0], &yValues[0], size);
+  const Type expectedNorm = std::sqrt(desola::detail::blockedSumOfSquares(&xValues[0], size));
+  const bool passed = identical(dot, expectedDot) && identical(norm, expectedNorm);
+
+  std::cout.precision(17);
+  std::cout << "Size: " << size << " Dot: " << dot << " (expected " << expectedDot << ") Two-Norm: " << norm 
+            << " (expected " << expectedNorm << ")" << (passed ? "" : " FAILED") << std::endl;
+
+  return passed;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  bool passed = true;
+
+  for(std::size_t index = 0; index < sizeof(sizes)/sizeof(sizes[0]); ++index)
+    passed = checkSize(sizes[index]) && passed;
+
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
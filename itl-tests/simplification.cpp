@@ -0,0 +1,157 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+// Evaluates expressions built from the ITL operations that the algebraic
+// simplifier is expected to rewrite, and checks both that the rewrites were
+// applied and that the results match the unsimplified expressions.
+
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <desola/Desola.hpp>
+#include <desola/itl_interface.hpp>
+
+using namespace itl;
+
+namespace
+{
+
+typedef double Type;
+typedef desola::Vector<Type> Vector;
+typedef desola::Scalar<Type> Scalar;
+
+const std::size_t size = 100;
+
+// Element i holds offset + i, so no operand is a constant that could be folded away
+Vector createRamp(const Type offset)
+{
+  Vector v(size, Type(0));
+
+  for(std::size_t i = 0; i < size; ++i)
+    v(i) = offset + i;
+
+  return v;
+}
+
+Type sumElements(const Vector& v)
+{
+  return dot(v, Vector(v.numRows(), Type(1))).value();
+}
+
+class SimplificationCheck
+{
+private:
+  const char* const name;
+  const int initialRewrites;
+
+public:
+  SimplificationCheck(const char* const n) : name(n), initialRewrites(desola::StatisticsCollector::getStatisticsCollector().getRewriteCount())
+  {
+  }
+
+  bool passes(const Type value, const Type expected, const int expectedRewrites) const
+  {
+    const int rewrites = desola::StatisticsCollector::getStatisticsCollector().getRewriteCount() - initialRewrites;
+    const bool valueMatches = std::abs(value - expected) <= 1e-12 * std::max(Type(1), std::abs(expected));
+    const bool rewritesMatch = rewrites == expectedRewrites;
+
+    std::cout << name << ": Value: " << value << " (expected " << expected << ") Rewrites: " << rewrites
+              << " (expected " << expectedRewrites << ")" << (valueMatches && rewritesMatch ? "" : " FAILED") << std::endl;
+
+    return valueMatches && rewritesMatch;
+  }
+};
+
+// x * a + y * b becomes a single axpby
+bool checkAxpby()
+{
+  const SimplificationCheck check("axpby");
+  const Vector x(createRamp(0)), y(createRamp(1));
+  Vector r(size, Type(0));
+
+  add(scaled(x, 3.0), scaled(y, 0.5), r);
+
+  Type expected = 0;
+  for(std::size_t i = 0; i < size; ++i)
+    expected += 3.0 * i + 0.5 * (1 + i);
+
+  return check.passes(sumElements(r), expected, 1);
+}
+
+// x - x becomes a zero vector, which leaves nothing for the dot product to read
+bool checkSelfDifference()
+{
+  const SimplificationCheck check("x - x");
+  const Vector x(createRamp(2));
+  const Vector d(x - x);
+
+  return check.passes(dot(d, d).value(), 0, 1);
+}
+
+// (x * a) * b and (x / a) / b are only reassociated when enabled, after which
+// the constant scalars are folded into one
+bool checkScalarChains(const bool reassociate)
+{
+  desola::ConfigurationManager::getConfigurationManager().enableScalarReassociation(reassociate);
+
+  const SimplificationCheck check(reassociate ? "reassociated scalar chains" : "scalar chains");
+  const Vector x(createRamp(1));
+  const Scalar a(2.0), b(4.0);
+  const Vector scaledTwice((x * a) * b);
+  const Vector dividedTwice((x / a) / b);
+
+  Type expected = 0;
+  for(std::size_t i = 0; i < size; ++i)
+    expected += 8.0 * (1 + i) + (1 + i) / 8.0;
+
+  const bool passed = check.passes(sumElements(scaledTwice + dividedTwice), expected, reassociate ? 4 : 0);
+  desola::ConfigurationManager::getConfigurationManager().enableScalarReassociation(false);
+  return passed;
+}
+
+// A slice of a slice becomes one slice, and a slice covering a whole vector becomes the vector
+bool checkSlices()
+{
+  const SimplificationCheck check("slices");
+  const Vector x(createRamp(0));
+  const Vector nested(x.slice(10, 40, 2).slice(5, 10, 3));
+  const Vector whole(x.slice(0, size));
+
+  Type expected = 0;
+  for(std::size_t i = 0; i < 10; ++i)
+    expected += 10 + 2 * (5 + 3 * i);
+  for(std::size_t i = 0; i < size; ++i)
+    expected += i;
+
+  return check.passes(sumElements(nested) + sumElements(whole), expected, 2);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  desola::ConfigurationManager::getConfigurationManager().enableAlgebraicSimplification(true);
+
+  bool passed = true;
+  passed = checkAxpby() && passed;
+  passed = checkSelfDifference() && passed;
+  passed = checkScalarChains(false) && passed;
+  passed = checkScalarChains(true) && passed;
+  passed = checkSlices() && passed;
+
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -38,6 +38,18 @@ SolverOptions::SolverOptions(const std::string& fileDesc) : description("Allowed
     ("array-contraction", po::value<bool>(&useArrayContraction)->default_value(true), "enable array contraction on runtime generated code")
     ("single-for-loop-sparse", po::value<bool>(&useSingleForLoopSparse)->default_value(false), "iterate over all elements in CRS matrices with a single for loop")
     ("sparse-specialisation", po::value<bool>(&useSparseSpecialisation)->default_value(false), "specialise generated code to sparse matrix row lengths")
+    ("threads", po::value<unsigned>(&threads)->default_value(1), "number of threads running independent generated kernels concurrently (0 for one per hardware thread)")
+    ("pin-threads", po::value<bool>(&useThreadPinning)->default_value(false), "pin evaluation threads to processors")
+    ("pipelined-evaluation", po::value<bool>(&usePipelinedEvaluation)->default_value(false), "queue evaluations on an execution thread while the next expression is built")
+    ("common-subexpression-elimination", po::value<bool>(&useCommonSubexpressionElimination)->default_value(true), "merge identical subexpressions before evaluation")
+    ("algebraic-simplification", po::value<bool>(&useAlgebraicSimplification)->default_value(true), "apply algebraic rewrites such as axpby fusion before evaluation")
+    ("scalar-reassociation", po::value<bool>(&useScalarReassociation)->default_value(false), "let simplification combine chained vector scalings, which may change rounding")
+    ("buffer-donation", po::value<bool>(&useBufferDonation)->default_value(true), "compute elementwise results in the storage of inputs that are no longer required")
+    ("storage-pool-limit", po::value<unsigned>(&storagePoolLimit)->default_value(256), "megabytes of freed vector and matrix storage kept for reuse")
+    ("huge-pages", po::value<bool>(&useHugePages)->default_value(false), "back large vectors and matrices with transparent huge pages")
+    ("max-pending-nodes", po::value<unsigned>(&maxPendingNodes)->default_value(1024), "evaluate assigned expressions depending on more unevaluated nodes than this (0 for no limit)")
+    ("max-pending-megabytes", po::value<unsigned>(&maxPendingMegabytes)->default_value(0), "evaluate assigned expressions whose unevaluated values exceed this size (0 for no limit)")
+    ("max-pending-depth", po::value<unsigned>(&maxPendingDepth)->default_value(0), "evaluate assigned expressions whose unevaluated graph is deeper than this (0 for no limit)")
     ("sparse", "use sparse representation for matrix storage")
     ("format", po::value<std::string>(&format)->default_value("hb"), "format of input file: Harwell-Boeing=hb, Matrix-Market=mm")
     ("single-line-result", "print statistics on single line")
@@ -46,6 +58,11 @@ SolverOptions::SolverOptions(const std::string& fileDesc) : description("Allowed
   positional_description.add("input-file", -1);
 }
 
+po::options_description_easy_init SolverOptions::addOptions()
+{
+  return description.add_options();
+}
+
 void SolverOptions::processOptions(int argc, char* argv[])
 {
   po::store(po::parse_command_line(argc, argv, description), vm);
@@ -81,6 +98,18 @@ void SolverOptions::processOptions(int argc, char* argv[])
   configurationManager.enableSingleForLoopSparseIteration(useSingleForLoopSparse);
   configurationManager.enableHighLevelFusion(useHighLevelFusion);
   configurationManager.enableSparseSpecialisation(useSparseSpecialisation);
+  configurationManager.setThreadCount(threads);
+  configurationManager.enableThreadPinning(useThreadPinning);
+  configurationManager.enablePipelinedEvaluation(usePipelinedEvaluation);
+  configurationManager.enableCommonSubexpressionElimination(useCommonSubexpressionElimination);
+  configurationManager.enableAlgebraicSimplification(useAlgebraicSimplification);
+  configurationManager.enableScalarReassociation(useScalarReassociation);
+  configurationManager.enableBufferDonation(useBufferDonation);
+  configurationManager.setStoragePoolLimit(static_cast<std::size_t>(storagePoolLimit) * 1024 * 1024);
+  configurationManager.enableHugePages(useHugePages);
+  configurationManager.setMaxPendingNodes(maxPendingNodes);
+  configurationManager.setMaxPendingBytes(static_cast<std::size_t>(maxPendingMegabytes) * 1024 * 1024);
+  configurationManager.setMaxPendingDepth(maxPendingDepth);
 }
 
 std::string SolverOptions::getFile() const
@@ -37,10 +37,24 @@ private:
   bool useSingleLineResult;
   bool useSingleForLoopSparse;
   bool useSparseSpecialisation;
+  unsigned threads;
+  bool useThreadPinning;
+  bool usePipelinedEvaluation;
+  bool useCommonSubexpressionElimination;
+  bool useAlgebraicSimplification;
+  bool useScalarReassociation;
+  bool useBufferDonation;
+  unsigned storagePoolLimit;
+  bool useHugePages;
+  unsigned maxPendingNodes;
+  unsigned maxPendingMegabytes;
+  unsigned maxPendingDepth;
   int iterations;
   
 public:
   SolverOptions(const std::string& fileDesc);
+  // Registers options specific to one benchmark, before processOptions is called
+  po::options_description_easy_init addOptions();
   void processOptions(int argc, char* argv[]);
   std::string getFile() const;
   bool singleLineResult() const;
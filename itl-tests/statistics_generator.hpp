@@ -56,11 +56,28 @@ public:
     std::cout << "Time per Iteration: " << elapsed / iter.iterations() << " seconds" << std::endl;
     std::cout << "Compile Time: " << statsCollector.getCompileTime() << " seconds" << std::endl;
     std::cout << "Compile Count: " << statsCollector.getCompileCount() << std::endl;
+    std::cout << "Graph Setup Time: " << statsCollector.getSetupTime() << " seconds" << std::endl;
     std::cout << "Total Time: " << elapsed << " seconds" << std::endl;
     std::cout << "FLOPs: " << statsCollector.getFlops() << std::endl;
     std::cout << "High-Level Fusion: " << getStatus(configManager.highLevelFusionEnabled()) << std::endl;
     std::cout << "Single For-Loop Sparse Iteration: " << getStatus(configManager.singleForLoopSparseIterationEnabled()) << std::endl;
     std::cout << "Sparse Row Length Specialisation: " << getStatus(configManager.sparseSpecialisationEnabled()) << std::endl;
+    std::cout << "Threads: " << configManager.getThreadCount() << std::endl;
+    std::cout << "Thread Pinning: " << getStatus(configManager.threadPinningEnabled()) << std::endl;
+    std::cout << "Common Subexpression Elimination: " << getStatus(configManager.commonSubexpressionEliminationEnabled()) << std::endl;
+    std::cout << "Eliminated Subexpressions: " << statsCollector.getEliminatedCount() << std::endl;
+    std::cout << "Eliminated Matrix-Vector Products: " << statsCollector.getEliminatedMatrixVectorMultCount() << std::endl;
+    std::cout << "Eliminated Dot Products: " << statsCollector.getEliminatedDotCount() << std::endl;
+    std::cout << "Algebraic Simplification: " << getStatus(configManager.algebraicSimplificationEnabled()) << std::endl;
+    std::cout << "Scalar Reassociation: " << getStatus(configManager.scalarReassociationEnabled()) << std::endl;
+    std::cout << "Rewritten Nodes: " << statsCollector.getRewriteCount() << std::endl;
+    std::cout << "Buffer Donation: " << getStatus(configManager.bufferDonationEnabled()) << std::endl;
+    std::cout << "Donated Buffers: " << statsCollector.getDonationCount() << std::endl;
+    std::cout << "Storage Pool Limit: " << configManager.getStoragePoolLimit() / (1024 * 1024) << " MB" << std::endl;
+    std::cout << "Huge Pages: " << getStatus(configManager.hugePagesEnabled()) << std::endl;
+    std::cout << "Maximum Pending Nodes: " << configManager.getMaxPendingNodes() << std::endl;
+    std::cout << "Maximum Pending Size: " << configManager.getMaxPendingBytes() / (1024 * 1024) << " MB" << std::endl;
+    std::cout << "Maximum Pending Depth: " << configManager.getMaxPendingDepth() << std::endl;
 
     if (options.useSparse())
       std::cout << "NNZ: " << nnz(matrix) << std::endl;
@@ -89,11 +106,28 @@ public:
     std::cout << "iterations=" << iter.iterations() << d;
     std::cout << "compile_time=" << statsCollector.getCompileTime() << d;
     std::cout << "compile_count=" << statsCollector.getCompileCount() << d;
+    std::cout << "setup_time=" << statsCollector.getSetupTime() << d;
     std::cout << "total_time=" << elapsed << d;
     std::cout << "flop=" << statsCollector.getFlops() << d;
     std::cout << "high_level_fusion=" << getStatus(configManager.highLevelFusionEnabled()) << d;
     std::cout << "single_for_loop_sparse=" << getStatus(configManager.singleForLoopSparseIterationEnabled()) << d;
     std::cout << "specialise_sparse=" << getStatus(configManager.sparseSpecialisationEnabled()) << d;
+    std::cout << "threads=" << configManager.getThreadCount() << d;
+    std::cout << "pin_threads=" << getStatus(configManager.threadPinningEnabled()) << d;
+    std::cout << "cse=" << getStatus(configManager.commonSubexpressionEliminationEnabled()) << d;
+    std::cout << "eliminated=" << statsCollector.getEliminatedCount() << d;
+    std::cout << "eliminated_matvec=" << statsCollector.getEliminatedMatrixVectorMultCount() << d;
+    std::cout << "eliminated_dot=" << statsCollector.getEliminatedDotCount() << d;
+    std::cout << "simplify=" << getStatus(configManager.algebraicSimplificationEnabled()) << d;
+    std::cout << "reassociate=" << getStatus(configManager.scalarReassociationEnabled()) << d;
+    std::cout << "rewritten=" << statsCollector.getRewriteCount() << d;
+    std::cout << "donation=" << getStatus(configManager.bufferDonationEnabled()) << d;
+    std::cout << "donated=" << statsCollector.getDonationCount() << d;
+    std::cout << "storage_pool_limit=" << configManager.getStoragePoolLimit() << d;
+    std::cout << "huge_pages=" << getStatus(configManager.hugePagesEnabled()) << d;
+    std::cout << "max_pending_nodes=" << configManager.getMaxPendingNodes() << d;
+    std::cout << "max_pending_bytes=" << configManager.getMaxPendingBytes() << d;
+    std::cout << "max_pending_depth=" << configManager.getMaxPendingDepth() << d;
 
     if (options.useSparse())
       std::cout << "nnz=" << nnz(matrix) << d;
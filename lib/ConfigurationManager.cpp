@@ -17,25 +17,29 @@
 
 #include <desola/ConfigurationManager.hpp>
 #include <desola/Cache.hpp>
+#include <desola/Context.hpp>
+#include <desola/StoragePool.hpp>
 #include <algorithm>
 #include <boost/functional.hpp>
 
 namespace desola
 {
 
-ConfigurationManager ConfigurationManager::configurationManager;
-
 ConfigurationManager::ConfigurationManager() : gcc(true), doCodeCaching(true), 
   doFusion(true), doHighLevelFusion(true), doArrayContraction(true), doLiveness(false), doSingleForLoopSparse(false), 
-  doSparseSpecialisation(false)
+  doSparseSpecialisation(false),
+  threadCount(1), doThreadPinning(false), doPipelinedEvaluation(false),
+  doCommonSubexpressionElimination(true), doAlgebraicSimplification(true), doScalarReassociation(false),
+  doBufferDonation(true), maxPendingNodes(1024), maxPendingBytes(0), maxPendingDepth(0)
 {
 }
 
 ConfigurationManager& ConfigurationManager::getConfigurationManager()
 {
-  return configurationManager;
+  return Context::getDefaultContext().getConfigurationManager();
 }
 
+// Called with the configuration lock held
 void ConfigurationManager::flushCaches()
 {
   std::for_each(caches.begin(), caches.end(), boost::mem_fun(&detail::Cache::flush)); 
@@ -44,110 +48,270 @@ void ConfigurationManager::flushCaches()
 
 void ConfigurationManager::registerCache(detail::Cache& cache)
 {
+  boost::mutex::scoped_lock lock(mutex);
   caches.insert(&cache);
 }
 
 void ConfigurationManager::unregisterCache(detail::Cache& cache)
 {
+  boost::mutex::scoped_lock lock(mutex);
   caches.erase(&cache);
 }
 
 void ConfigurationManager::useGCC()
 {
+  boost::mutex::scoped_lock lock(mutex);
   flushCaches();
   gcc=true;
 }
 
 void ConfigurationManager::useICC()
 {
+  boost::mutex::scoped_lock lock(mutex);
   flushCaches();
   gcc=false;
 }
 
 bool ConfigurationManager::usingGCC() const
 {
+  boost::mutex::scoped_lock lock(mutex);
   return gcc;
 }
 
 bool ConfigurationManager::usingICC() const
 {
+  boost::mutex::scoped_lock lock(mutex);
   return !gcc;
 }
 
 void ConfigurationManager::enableLivenessAnalysis(const bool enabled)
 {
+  boost::mutex::scoped_lock lock(mutex);
   flushCaches();
   doLiveness=enabled;
 }
 
 bool ConfigurationManager::livenessAnalysisEnabled() const
 {
+  boost::mutex::scoped_lock lock(mutex);
   return doLiveness;
 }
 
 void ConfigurationManager::enableCodeCaching(const bool enabled)
 {
+  boost::mutex::scoped_lock lock(mutex);
   flushCaches();
   doCodeCaching=enabled;
 }
 
 bool ConfigurationManager::codeCachingEnabled() const
 {
+  boost::mutex::scoped_lock lock(mutex);
   return doCodeCaching;
 }
 
 void ConfigurationManager::enableLoopFusion(const bool enabled) 
 {
+  boost::mutex::scoped_lock lock(mutex);
   flushCaches();
   doFusion = enabled;
 }
 
 bool ConfigurationManager::loopFusionEnabled() const
 {
+  boost::mutex::scoped_lock lock(mutex);
   return doFusion;
 }
 
 void ConfigurationManager::enableHighLevelFusion(const bool enabled)
 {
+  boost::mutex::scoped_lock lock(mutex);
   flushCaches();
   doHighLevelFusion = enabled;
 }
 
 bool ConfigurationManager::highLevelFusionEnabled() const
 {
+  boost::mutex::scoped_lock lock(mutex);
   return doHighLevelFusion;
 }
 
 void ConfigurationManager::enableArrayContraction(const bool enabled)
 {
+  boost::mutex::scoped_lock lock(mutex);
   flushCaches();
   doArrayContraction=enabled;
 }
 
 bool ConfigurationManager::arrayContractionEnabled() const
 {
+  boost::mutex::scoped_lock lock(mutex);
   return doArrayContraction;
 }
 
 void ConfigurationManager::enableSingleForLoopSparseIteration(const bool enabled)
 {
+  boost::mutex::scoped_lock lock(mutex);
   flushCaches();
   doSingleForLoopSparse = enabled;
 }
 
 bool ConfigurationManager::singleForLoopSparseIterationEnabled() const
 {
+  boost::mutex::scoped_lock lock(mutex);
   return doSingleForLoopSparse;
 }
 
 void ConfigurationManager::enableSparseSpecialisation(const bool enabled)
 {
+  boost::mutex::scoped_lock lock(mutex);
   doSparseSpecialisation = enabled;
 }
 
 bool ConfigurationManager::sparseSpecialisationEnabled() const
 {
+  boost::mutex::scoped_lock lock(mutex);
   return doSparseSpecialisation;
 }
 
+void ConfigurationManager::setThreadCount(const std::size_t threads)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  threadCount = threads;
+}
+
+std::size_t ConfigurationManager::getThreadCount() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return threadCount;
+}
+
+void ConfigurationManager::enableThreadPinning(const bool enabled)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  doThreadPinning = enabled;
+}
+
+bool ConfigurationManager::threadPinningEnabled() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return doThreadPinning;
+}
+
+void ConfigurationManager::enablePipelinedEvaluation(const bool enabled)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  doPipelinedEvaluation = enabled;
+}
+
+bool ConfigurationManager::pipelinedEvaluationEnabled() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return doPipelinedEvaluation;
+}
+
+void ConfigurationManager::enableCommonSubexpressionElimination(const bool enabled)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  doCommonSubexpressionElimination = enabled;
+}
+
+bool ConfigurationManager::commonSubexpressionEliminationEnabled() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return doCommonSubexpressionElimination;
+}
+
+void ConfigurationManager::enableAlgebraicSimplification(const bool enabled)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  doAlgebraicSimplification = enabled;
+}
+
+bool ConfigurationManager::algebraicSimplificationEnabled() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return doAlgebraicSimplification;
+}
+
+void ConfigurationManager::enableScalarReassociation(const bool enabled)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  doScalarReassociation = enabled;
+}
+
+bool ConfigurationManager::scalarReassociationEnabled() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return doScalarReassociation;
+}
+
+void ConfigurationManager::enableBufferDonation(const bool enabled)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  doBufferDonation = enabled;
+}
+
+bool ConfigurationManager::bufferDonationEnabled() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return doBufferDonation;
+}
+
+void ConfigurationManager::setMaxPendingNodes(const std::size_t nodes)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  maxPendingNodes = nodes;
+}
+
+std::size_t ConfigurationManager::getMaxPendingNodes() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return maxPendingNodes;
+}
+
+void ConfigurationManager::setMaxPendingBytes(const std::size_t bytes)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  maxPendingBytes = bytes;
+}
+
+std::size_t ConfigurationManager::getMaxPendingBytes() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return maxPendingBytes;
+}
+
+void ConfigurationManager::setMaxPendingDepth(const std::size_t depth)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  maxPendingDepth = depth;
+}
+
+std::size_t ConfigurationManager::getMaxPendingDepth() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return maxPendingDepth;
+}
+
+void ConfigurationManager::setStoragePoolLimit(const std::size_t bytes)
+{
+  detail::StoragePool::setLimit(bytes);
+}
+
+std::size_t ConfigurationManager::getStoragePoolLimit()
+{
+  return detail::StoragePool::getLimit();
+}
+
+void ConfigurationManager::enableHugePages(const bool enabled)
+{
+  detail::StoragePool::enableHugePages(enabled);
+}
+
+bool ConfigurationManager::hugePagesEnabled()
+{
+  return detail::StoragePool::hugePagesEnabled();
+}
+
 }
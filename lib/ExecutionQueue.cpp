@@ -0,0 +1,132 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#include <desola/ExecutionQueue.hpp>
+#include <cassert>
+#include <boost/bind.hpp>
+
+namespace desola
+{
+
+namespace detail
+{
+
+ExecutionTicket::ExecutionTicket() : done(false)
+{
+}
+
+void ExecutionTicket::complete(const boost::exception_ptr& e)
+{
+  {
+    boost::mutex::scoped_lock lock(mutex);
+    error = e;
+    done.store(true, boost::memory_order_release);
+  }
+
+  finished.notify_all();
+}
+
+bool ExecutionTicket::isComplete() const
+{
+  return done.load(boost::memory_order_acquire);
+}
+
+void ExecutionTicket::wait()
+{
+  if (!isComplete())
+  {
+    boost::mutex::scoped_lock lock(mutex);
+
+    while(!done.load(boost::memory_order_acquire))
+      finished.wait(lock);
+  }
+}
+
+boost::exception_ptr ExecutionTicket::getError() const
+{
+  assert(isComplete());
+  return error;
+}
+
+ExecutionQueue::ExecutionQueue() : stopping(false)
+{
+}
+
+ExecutionQueue::~ExecutionQueue()
+{
+  {
+    boost::mutex::scoped_lock lock(mutex);
+    stopping = true;
+  }
+
+  workAvailable.notify_all();
+
+  if (thread)
+    thread->join();
+}
+
+void ExecutionQueue::submit(const Task& task, const boost::shared_ptr<ExecutionTicket>& ticket)
+{
+  {
+    boost::mutex::scoped_lock lock(mutex);
+    assert(!stopping);
+    tasks.push_back(std::make_pair(task, ticket));
+
+    if (!thread)
+      thread.reset(new boost::thread(boost::bind(&ExecutionQueue::run, this)));
+  }
+
+  workAvailable.notify_one();
+}
+
+void ExecutionQueue::run()
+{
+  while(true)
+  {
+    std::pair< Task, boost::shared_ptr<ExecutionTicket> > next;
+
+    {
+      boost::mutex::scoped_lock lock(mutex);
+
+      while(tasks.empty() && !stopping)
+        workAvailable.wait(lock);
+
+      if (tasks.empty())
+        return;
+
+      next = tasks.front();
+      tasks.pop_front();
+    }
+
+    boost::exception_ptr error;
+
+    try
+    {
+      next.first();
+    }
+    catch(...)
+    {
+      error = boost::current_exception();
+    }
+
+    next.second->complete(error);
+  }
+}
+
+}
+
+}
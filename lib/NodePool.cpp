@@ -0,0 +1,214 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#include <desola/NodePool.hpp>
+#include <new>
+#include <cassert>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+namespace desola
+{
+
+namespace detail
+{
+
+struct NodePool::SharedState
+{
+  boost::mutex mutex;
+  FreeBlock* freeLists[classCount];
+  std::size_t chunks;
+
+  SharedState() : chunks(0)
+  {
+    for(std::size_t sizeClass = 0; sizeClass < classCount; ++sizeClass)
+      freeLists[sizeClass] = NULL;
+  }
+};
+
+struct NodePool::ThreadCache
+{
+  FreeBlock* freeLists[classCount];
+  std::size_t freeCounts[classCount];
+  std::size_t allocations;
+
+  ThreadCache() : allocations(0)
+  {
+    for(std::size_t sizeClass = 0; sizeClass < classCount; ++sizeClass)
+    {
+      freeLists[sizeClass] = NULL;
+      freeCounts[sizeClass] = 0;
+    }
+  }
+
+  ~ThreadCache()
+  {
+    SharedState& shared(getSharedState());
+    boost::mutex::scoped_lock lock(shared.mutex);
+
+    for(std::size_t sizeClass = 0; sizeClass < classCount; ++sizeClass)
+    {
+      FreeBlock* const head = freeLists[sizeClass];
+
+      if (head != NULL)
+      {
+        FreeBlock* tail = head;
+
+        while(tail->next != NULL)
+          tail = tail->next;
+
+        tail->next = shared.freeLists[sizeClass];
+        shared.freeLists[sizeClass] = head;
+      }
+    }
+  }
+};
+
+// The pool state is never destroyed, since nodes held by static objects such as the default
+// context's caches may be freed during static destruction.
+NodePool::SharedState& NodePool::getSharedState()
+{
+  static SharedState* const shared = new SharedState();
+  return *shared;
+}
+
+NodePool::ThreadCache& NodePool::getThreadCache()
+{
+  static boost::thread_specific_ptr<ThreadCache>* const threadCache = new boost::thread_specific_ptr<ThreadCache>();
+  ThreadCache* cache = threadCache->get();
+
+  if (cache == NULL)
+  {
+    cache = new ThreadCache();
+    threadCache->reset(cache);
+  }
+
+  return *cache;
+}
+
+void NodePool::refill(ThreadCache& cache, const std::size_t sizeClass)
+{
+  assert(cache.freeLists[sizeClass] == NULL);
+  SharedState& shared(getSharedState());
+  boost::mutex::scoped_lock lock(shared.mutex);
+
+  // Use blocks released by other threads before carving a new chunk
+  if (shared.freeLists[sizeClass] == NULL)
+  {
+    const std::size_t blockSize = (sizeClass + 1) * granularity;
+    const std::size_t blockCount = chunkSize / blockSize;
+    char* const chunk = static_cast<char*>(::operator new(chunkSize));
+    ++shared.chunks;
+
+    for(std::size_t block = blockCount; block > 0; --block)
+    {
+      FreeBlock* const freeBlock = reinterpret_cast<FreeBlock*>(chunk + (block - 1) * blockSize);
+      freeBlock->next = shared.freeLists[sizeClass];
+      shared.freeLists[sizeClass] = freeBlock;
+    }
+  }
+
+  FreeBlock* const head = shared.freeLists[sizeClass];
+  FreeBlock* tail = head;
+  std::size_t count = 1;
+
+  while(count < getBatchSize(sizeClass) && tail->next != NULL)
+  {
+    tail = tail->next;
+    ++count;
+  }
+
+  shared.freeLists[sizeClass] = tail->next;
+  tail->next = NULL;
+  cache.freeLists[sizeClass] = head;
+  cache.freeCounts[sizeClass] = count;
+}
+
+void NodePool::release(ThreadCache& cache, const std::size_t sizeClass)
+{
+  const std::size_t batchSize = getBatchSize(sizeClass);
+  assert(cache.freeCounts[sizeClass] > batchSize);
+
+  FreeBlock* const head = cache.freeLists[sizeClass];
+  FreeBlock* tail = head;
+
+  for(std::size_t count = 1; count < batchSize; ++count)
+    tail = tail->next;
+
+  cache.freeLists[sizeClass] = tail->next;
+  cache.freeCounts[sizeClass] -= batchSize;
+
+  SharedState& shared(getSharedState());
+  boost::mutex::scoped_lock lock(shared.mutex);
+  tail->next = shared.freeLists[sizeClass];
+  shared.freeLists[sizeClass] = head;
+}
+
+void* NodePool::allocate(const std::size_t size)
+{
+  if (size == 0 || size > maxPooledSize)
+    return ::operator new(size);
+
+  const std::size_t sizeClass = getSizeClass(size);
+  ThreadCache& cache(getThreadCache());
+
+  if (cache.freeLists[sizeClass] == NULL)
+    refill(cache, sizeClass);
+
+  FreeBlock* const block = cache.freeLists[sizeClass];
+  cache.freeLists[sizeClass] = block->next;
+  --cache.freeCounts[sizeClass];
+  ++cache.allocations;
+  return block;
+}
+
+void NodePool::deallocate(void* const p, const std::size_t size)
+{
+  if (p == NULL)
+    return;
+
+  if (size == 0 || size > maxPooledSize)
+  {
+    ::operator delete(p);
+    return;
+  }
+
+  const std::size_t sizeClass = getSizeClass(size);
+  ThreadCache& cache(getThreadCache());
+  FreeBlock* const block = static_cast<FreeBlock*>(p);
+  block->next = cache.freeLists[sizeClass];
+  cache.freeLists[sizeClass] = block;
+
+  if (++cache.freeCounts[sizeClass] > maxBatchesPerThread * getBatchSize(sizeClass))
+    release(cache, sizeClass);
+}
+
+std::size_t NodePool::getAllocationCount()
+{
+  return getThreadCache().allocations;
+}
+
+std::size_t NodePool::getChunkCount()
+{
+  SharedState& shared(getSharedState());
+  boost::mutex::scoped_lock lock(shared.mutex);
+  return shared.chunks;
+}
+
+}
+
+}
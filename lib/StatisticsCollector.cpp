@@ -17,64 +17,160 @@
 
 #include <desola/StatisticsCollector.hpp>
 #include <desola/Maybe.hpp>
+#include <desola/Context.hpp>
 
 namespace desola
 {
 
-StatisticsCollector StatisticsCollector::statsCollector;
-
-StatisticsCollector::StatisticsCollector() : compileTime(0.0), compileCount(0), flops(0.0)
+StatisticsCollector::StatisticsCollector() : compileTime(0.0), setupTime(0.0), compileCount(0), flops(0.0), eliminatedCount(0), eliminatedMatrixVectorMultCount(0), eliminatedDotCount(0), rewriteCount(0), donationCount(0)
 {
 }
 
 StatisticsCollector& StatisticsCollector::getStatisticsCollector()
 {
-  return statsCollector;
+  return Context::getDefaultContext().getStatisticsCollector();
 }
 
 double StatisticsCollector::getCompileTime() const
 {
+  boost::mutex::scoped_lock lock(mutex);
   return compileTime;
 }
 
 void StatisticsCollector::addCompileTime(const double time)
 {
+  boost::mutex::scoped_lock lock(mutex);
   compileTime += time;
 }
 
 void StatisticsCollector::resetCompileTime()
 {
+  boost::mutex::scoped_lock lock(mutex);
   compileTime=0.0;
 }
 
+double StatisticsCollector::getSetupTime() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return setupTime;
+}
+
+void StatisticsCollector::addSetupTime(const double time)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  setupTime += time;
+}
+
+void StatisticsCollector::resetSetupTime()
+{
+  boost::mutex::scoped_lock lock(mutex);
+  setupTime=0.0;
+}
+
 int StatisticsCollector::getCompileCount() const
 {
+  boost::mutex::scoped_lock lock(mutex);
   return compileCount;
 }
 
 void StatisticsCollector::incrementCompileCount()
 {
+  boost::mutex::scoped_lock lock(mutex);
   ++compileCount;
 }
 
 void StatisticsCollector::resetCompileCount()
 {
+  boost::mutex::scoped_lock lock(mutex);
   compileCount=0;
 }
 
 Maybe<double> StatisticsCollector::getFlops() const
 {
+  boost::mutex::scoped_lock lock(mutex);
   return flops;
 }
 
 void StatisticsCollector::addFlops(const Maybe<double>& f)
 {
+  boost::mutex::scoped_lock lock(mutex);
   flops+=f;
 }
 
 void StatisticsCollector::resetFlops()
 {
+  boost::mutex::scoped_lock lock(mutex);
   flops = Maybe<double>(0.0);
 }
 
+int StatisticsCollector::getEliminatedCount() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return eliminatedCount;
+}
+
+int StatisticsCollector::getEliminatedMatrixVectorMultCount() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return eliminatedMatrixVectorMultCount;
+}
+
+int StatisticsCollector::getEliminatedDotCount() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return eliminatedDotCount;
+}
+
+void StatisticsCollector::addEliminated(const int total, const int matrixVectorMults, const int dots)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  eliminatedCount += total;
+  eliminatedMatrixVectorMultCount += matrixVectorMults;
+  eliminatedDotCount += dots;
+}
+
+void StatisticsCollector::resetEliminated()
+{
+  boost::mutex::scoped_lock lock(mutex);
+  eliminatedCount = 0;
+  eliminatedMatrixVectorMultCount = 0;
+  eliminatedDotCount = 0;
+}
+
+int StatisticsCollector::getRewriteCount() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return rewriteCount;
+}
+
+void StatisticsCollector::addRewrites(const int rewrites)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  rewriteCount += rewrites;
+}
+
+void StatisticsCollector::resetRewrites()
+{
+  boost::mutex::scoped_lock lock(mutex);
+  rewriteCount = 0;
+}
+
+int StatisticsCollector::getDonationCount() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return donationCount;
+}
+
+void StatisticsCollector::addDonations(const int donations)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  donationCount += donations;
+}
+
+void StatisticsCollector::resetDonations()
+{
+  boost::mutex::scoped_lock lock(mutex);
+  donationCount = 0;
+}
+
 }
@@ -0,0 +1,196 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#include <desola/StoragePool.hpp>
+#include <new>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <cassert>
+#include <cstdlib>
+#include <boost/thread/mutex.hpp>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace desola
+{
+
+namespace detail
+{
+
+struct StoragePool::SharedState
+{
+  boost::mutex mutex;
+  std::map< std::size_t, std::vector<void*> > freeLists;
+  std::size_t limit;
+  std::size_t cachedBytes;
+  std::size_t heapAllocations;
+  bool useHugePages;
+
+  SharedState() : limit(256 * 1024 * 1024), cachedBytes(0), heapAllocations(0), useHugePages(false)
+  {
+  }
+};
+
+StoragePool::SharedState& StoragePool::getSharedState()
+{
+  static SharedState* const shared = new SharedState();
+  return *shared;
+}
+
+// Small arrays are rounded to the alignment and larger ones to whole pages, so values of
+// slightly different sizes can share freed arrays
+std::size_t StoragePool::getSizeClass(const std::size_t bytes)
+{
+  const std::size_t granularity = bytes < largeGranularity ? smallGranularity : largeGranularity;
+  return std::max(granularity, ((bytes + granularity - 1) / granularity) * granularity);
+}
+
+void* StoragePool::allocateFromHeap(const std::size_t bytes, const bool useHugePages)
+{
+  const bool huge = useHugePages && bytes >= hugePageSize;
+  void* p = NULL;
+
+  if (posix_memalign(&p, huge ? hugePageSize : alignment, bytes) != 0)
+    throw std::bad_alloc();
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (huge)
+    madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+
+  return p;
+}
+
+void* StoragePool::allocate(const std::size_t bytes)
+{
+  const std::size_t sizeClass = getSizeClass(bytes);
+  SharedState& shared(getSharedState());
+  bool useHugePages;
+
+  {
+    boost::mutex::scoped_lock lock(shared.mutex);
+    const std::map< std::size_t, std::vector<void*> >::iterator freeList = shared.freeLists.find(sizeClass);
+
+    if (freeList != shared.freeLists.end() && !freeList->second.empty())
+    {
+      void* const p = freeList->second.back();
+      freeList->second.pop_back();
+      shared.cachedBytes -= sizeClass;
+      return p;
+    }
+
+    ++shared.heapAllocations;
+    useHugePages = shared.useHugePages;
+  }
+
+  return allocateFromHeap(sizeClass, useHugePages);
+}
+
+void StoragePool::deallocate(void* const p, const std::size_t bytes)
+{
+  if (p == NULL)
+    return;
+
+  const std::size_t sizeClass = getSizeClass(bytes);
+  SharedState& shared(getSharedState());
+
+  {
+    boost::mutex::scoped_lock lock(shared.mutex);
+
+    if (shared.cachedBytes + sizeClass <= shared.limit)
+    {
+      shared.freeLists[sizeClass].push_back(p);
+      shared.cachedBytes += sizeClass;
+      return;
+    }
+  }
+
+  free(p);
+}
+
+void StoragePool::setLimit(const std::size_t bytes)
+{
+  SharedState& shared(getSharedState());
+  bool exceeded;
+
+  {
+    boost::mutex::scoped_lock lock(shared.mutex);
+    shared.limit = bytes;
+    exceeded = shared.cachedBytes > bytes;
+  }
+
+  if (exceeded)
+    release();
+}
+
+std::size_t StoragePool::getLimit()
+{
+  SharedState& shared(getSharedState());
+  boost::mutex::scoped_lock lock(shared.mutex);
+  return shared.limit;
+}
+
+void StoragePool::enableHugePages(const bool enabled)
+{
+  SharedState& shared(getSharedState());
+  boost::mutex::scoped_lock lock(shared.mutex);
+  shared.useHugePages = enabled;
+}
+
+bool StoragePool::hugePagesEnabled()
+{
+  SharedState& shared(getSharedState());
+  boost::mutex::scoped_lock lock(shared.mutex);
+  return shared.useHugePages;
+}
+
+void StoragePool::release()
+{
+  SharedState& shared(getSharedState());
+  std::map< std::size_t, std::vector<void*> > released;
+
+  {
+    boost::mutex::scoped_lock lock(shared.mutex);
+    released.swap(shared.freeLists);
+    shared.cachedBytes = 0;
+  }
+
+  for(std::map< std::size_t, std::vector<void*> >::const_iterator freeList = released.begin(); freeList != released.end(); ++freeList)
+    for(std::vector<void*>::const_iterator arrayIter = freeList->second.begin(); arrayIter != freeList->second.end(); ++arrayIter)
+      free(*arrayIter);
+}
+
+std::size_t StoragePool::getCachedBytes()
+{
+  SharedState& shared(getSharedState());
+  boost::mutex::scoped_lock lock(shared.mutex);
+  return shared.cachedBytes;
+}
+
+std::size_t StoragePool::getHeapAllocationCount()
+{
+  SharedState& shared(getSharedState());
+  boost::mutex::scoped_lock lock(shared.mutex);
+  return shared.heapAllocations;
+}
+
+}
+
+}
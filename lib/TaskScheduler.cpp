@@ -0,0 +1,268 @@
+/****************************************************************************/
+/* Copyright 2005-2006, Francis Russell                                     */
+/*                                                                          */
+/* Licensed under the Apache License, Version 2.0 (the License);            */
+/* you may not use this file except in compliance with the License.         */
+/* You may obtain a copy of the License at                                  */
+/*                                                                          */
+/*     http://www.apache.org/licenses/LICENSE-2.0                           */
+/*                                                                          */
+/* Unless required by applicable law or agreed to in writing, software      */
+/* distributed under the License is distributed on an AS IS BASIS,          */
+/* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/* See the License for the specific language governing permissions and      */
+/* limitations under the License.                                           */
+/*                                                                          */
+/****************************************************************************/
+
+#include <desola/TaskScheduler.hpp>
+#include <desola/ConfigurationManager.hpp>
+#include <cassert>
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace desola
+{
+
+namespace detail
+{
+
+TaskGroup::TaskGroup(TaskScheduler& s, const ConfigurationManager& configurationManager) : scheduler(s), pending(0)
+{
+  scheduler.beginGroup(configurationManager);
+}
+
+TaskGroup::~TaskGroup()
+{
+  assert(pending == 0);
+  scheduler.endGroup();
+}
+
+TaskScheduler::TaskScheduler() : activeGroups(0), threadCount(1), pinned(false), stopping(false)
+{
+}
+
+TaskScheduler::~TaskScheduler()
+{
+  stop();
+}
+
+boost::shared_ptr<TaskScheduler> TaskScheduler::getTaskScheduler()
+{
+  static const boost::shared_ptr<TaskScheduler> scheduler(new TaskScheduler());
+  return scheduler;
+}
+
+std::size_t TaskScheduler::getThreadCount() const
+{
+  return threadCount;
+}
+
+void TaskScheduler::beginGroup(const ConfigurationManager& configurationManager)
+{
+  boost::mutex::scoped_lock lock(configMutex);
+
+  // The pool is only resized when no other evaluation is using it
+  if (activeGroups++ == 0)
+    configure(configurationManager);
+}
+
+void TaskScheduler::endGroup()
+{
+  boost::mutex::scoped_lock lock(configMutex);
+  assert(activeGroups > 0);
+  --activeGroups;
+}
+
+void TaskScheduler::configure(const ConfigurationManager& configurationManager)
+{
+  std::size_t threads = configurationManager.getThreadCount();
+
+  if (threads == 0)
+    threads = std::max(1u, boost::thread::hardware_concurrency());
+
+  const bool pin = configurationManager.threadPinningEnabled();
+
+  if (threads != threadCount || pin != pinned)
+  {
+    stop();
+    start(threads, pin);
+  }
+}
+
+void TaskScheduler::start(const std::size_t threads, const bool pin)
+{
+  assert(threads > 0);
+  assert(tasks.empty());
+
+  stopping = false;
+  threadCount = threads;
+  pinned = pin;
+
+  for(std::size_t index = 1; index < threads; ++index)
+    workers.push_back(new boost::thread(boost::bind(&TaskScheduler::workerLoop, this, index)));
+}
+
+void TaskScheduler::stop()
+{
+  {
+    boost::mutex::scoped_lock lock(stateMutex);
+    stopping = true;
+  }
+
+  workAvailable.notify_all();
+
+  for(boost::ptr_vector<boost::thread>::iterator workerIter = workers.begin(); workerIter != workers.end(); ++workerIter)
+    workerIter->join();
+
+  workers.clear();
+}
+
+void TaskScheduler::pinCurrentThread(const std::size_t cpu)
+{
+#ifdef __linux__
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(cpu, &cpuSet);
+  pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#endif
+}
+
+void TaskScheduler::workerLoop(const std::size_t index)
+{
+  if (pinned)
+    pinCurrentThread(index % std::max(1u, boost::thread::hardware_concurrency()));
+
+  while(true)
+  {
+    QueuedTask task;
+    {
+      boost::mutex::scoped_lock lock(stateMutex);
+
+      while(tasks.empty() && !stopping)
+        workAvailable.wait(lock);
+
+      if (stopping)
+        return;
+
+      task = tasks.front();
+      tasks.pop_front();
+    }
+
+    runTask(task);
+  }
+}
+
+bool TaskScheduler::tryPop(const TaskGroup& group, QueuedTask& task)
+{
+  boost::mutex::scoped_lock lock(stateMutex);
+
+  for(std::deque<QueuedTask>::iterator taskIter = tasks.begin(); taskIter != tasks.end(); ++taskIter)
+  {
+    if (taskIter->second == &group)
+    {
+      task = *taskIter;
+      tasks.erase(taskIter);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool TaskScheduler::tryRunTask(const TaskGroup& group)
+{
+  QueuedTask task;
+
+  if (tryPop(group, task))
+  {
+    runTask(task);
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+}
+
+void TaskScheduler::runTask(QueuedTask& task)
+{
+  TaskGroup& group(*task.second);
+
+  try
+  {
+    task.first();
+  }
+  catch(...)
+  {
+    boost::mutex::scoped_lock lock(group.mutex);
+
+    if (!group.error)
+      group.error = boost::current_exception();
+  }
+
+  boost::mutex::scoped_lock lock(group.mutex);
+  assert(group.pending > 0);
+
+  if (--group.pending == 0)
+    group.finished.notify_all();
+}
+
+void TaskScheduler::submit(TaskGroup& group, const Task& task)
+{
+  {
+    boost::mutex::scoped_lock lock(group.mutex);
+    ++group.pending;
+  }
+
+  {
+    boost::mutex::scoped_lock lock(stateMutex);
+    tasks.push_back(std::make_pair(task, &group));
+  }
+
+  workAvailable.notify_one();
+}
+
+void TaskScheduler::wait(TaskGroup& group)
+{
+  while(true)
+  {
+    {
+      boost::mutex::scoped_lock lock(group.mutex);
+
+      if (group.pending == 0)
+        break;
+    }
+
+    if (!tryRunTask(group))
+    {
+      // None of the group's tasks are queued, so the remaining ones are running elsewhere
+      boost::mutex::scoped_lock lock(group.mutex);
+
+      if (group.pending == 0)
+        break;
+
+      group.finished.timed_wait(lock, boost::posix_time::milliseconds(1));
+    }
+  }
+
+  boost::exception_ptr error;
+  {
+    boost::mutex::scoped_lock lock(group.mutex);
+    error = group.error;
+    group.error = boost::exception_ptr();
+  }
+
+  if (error)
+    boost::rethrow_exception(error);
+}
+
+}
+
+}